@@ -0,0 +1,337 @@
+// llc is a compiler for a toy language
+// Copyright (C) 2014  Logan Romantic
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+#include <random>
+#include "corpus.h"
+
+namespace llc
+{
+    const CorpusMix kCorpusMixes[] = {
+        //name           ident kw  num str cmt op
+        { "balanced",      30, 15, 10,  5,  5, 35 },
+        { "identifiers",   70, 20,  2,  1,  1,  6 },
+        { "comments",      15,  5,  5,  2, 50, 23 },
+        { "numbers",       15,  5, 50,  2,  2, 26 },
+        { "strings",       15,  5,  5, 45,  2, 28 },
+        { "operators",     15,  5,  5,  2,  2, 71 },
+    };
+    const std::size_t kCorpusMixCount = sizeof(kCorpusMixes) / sizeof(kCorpusMixes[0]);
+
+    const char* const kKeywords[] = {
+        "program", "is", "begin", "end", "global", "procedure", "in", "out",
+        "integer", "float", "bool", "string", "if", "then", "else", "for",
+        "return", "not", "true", "false",
+    };
+
+    const char* const kOperators[] = {
+        ";", ",", "(", ")", "[", "]", ":=", "|", "&", "+", "-", "*", "/",
+        "<", ">", "<=", ">=", "==", "!=",
+    };
+
+    const CorpusMix* FindCorpusMix(const std::string& name)
+    {
+        for (std::size_t i = 0; i < kCorpusMixCount; ++i)
+        {
+            if (name == kCorpusMixes[i].name)
+            {
+                return &kCorpusMixes[i];
+            }
+        }
+        return nullptr;
+    }
+
+    class CorpusWriter
+    {
+    public:
+        CorpusWriter(const CorpusMix& mix, std::uint32_t seed)
+            : mix_(mix), rng_(seed)
+        {
+            total_ = mix.identifiers + mix.keywords + mix.numbers + mix.strings + mix.comments + mix.operators;
+        }
+
+        void Line(std::string& out)
+        {
+            out.append(4 * Uniform(1, 4), ' ');
+
+            unsigned items = Uniform(3, 12);
+            for (unsigned i = 0; i < items; ++i)
+            {
+                if (i > 0)
+                {
+                    out.push_back(' ');
+                }
+                if (Item(out))
+                {
+                    break;
+                }
+            }
+            out.push_back('\n');
+        }
+
+    private:
+        unsigned Uniform(unsigned lo, unsigned hi)
+        {
+            return std::uniform_int_distribution<unsigned>(lo, hi)(rng_);
+        }
+
+        void Word(std::string& out, unsigned length)
+        {
+            static const char first[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+            static const char rest[] = "abcdefghijklmnopqrstuvwxyz_0123456789";
+            out.push_back(first[Uniform(0, sizeof(first) - 2)]);
+            for (unsigned i = 1; i < length; ++i)
+            {
+                out.push_back(rest[Uniform(0, sizeof(rest) - 2)]);
+            }
+        }
+
+        //Returns true when the item ends the line
+        bool Item(std::string& out)
+        {
+            unsigned pick = Uniform(0, total_ - 1);
+
+            if (pick < mix_.identifiers)
+            {
+                Word(out, Uniform(1, 16));
+                return false;
+            }
+            pick -= mix_.identifiers;
+
+            if (pick < mix_.keywords)
+            {
+                out += kKeywords[Uniform(0, sizeof(kKeywords) / sizeof(kKeywords[0]) - 1)];
+                return false;
+            }
+            pick -= mix_.keywords;
+
+            if (pick < mix_.numbers)
+            {
+                out += std::to_string(Uniform(0, 1000000));
+                if (Uniform(0, 3) == 0)
+                {
+                    out += "_000";
+                }
+                return false;
+            }
+            pick -= mix_.numbers;
+
+            if (pick < mix_.strings)
+            {
+                out.push_back('"');
+                unsigned words = Uniform(1, 6);
+                for (unsigned i = 0; i < words; ++i)
+                {
+                    if (i > 0)
+                    {
+                        out.push_back(' ');
+                    }
+                    Word(out, Uniform(1, 8));
+                }
+                out.push_back('"');
+                return false;
+            }
+            pick -= mix_.strings;
+
+            if (pick < mix_.comments)
+            {
+                out += "//";
+                unsigned words = Uniform(2, 12);
+                for (unsigned i = 0; i < words; ++i)
+                {
+                    out.push_back(' ');
+                    Word(out, Uniform(1, 10));
+                }
+                return true;
+            }
+
+            out += kOperators[Uniform(0, sizeof(kOperators) / sizeof(kOperators[0]) - 1)];
+            return false;
+        }
+
+        const CorpusMix& mix_;
+        std::mt19937 rng_;
+        unsigned total_;
+    };
+
+    class ProgramWriter
+    {
+    public:
+        ProgramWriter(std::uint32_t seed)
+            : rng_(seed), procedures_(0)
+        {}
+
+        void Header(std::string& out)
+        {
+            out += "program bench is\n";
+            out += "    global integer total;\n";
+            out += "    global float samples[64];\n";
+        }
+
+        void Procedure(std::string& out)
+        {
+            std::string name = "p" + std::to_string(procedures_);
+            out += "\n    // " + name + " mixes the locals with its parameters\n";
+            out += "    procedure " + name + "(integer a in, float b in, integer c out)\n";
+            out += "        integer x;\n        float y[16];\n        bool f;\n        string s;\n";
+            out += "    begin\n";
+            unsigned count = Uniform(4, 12);
+            for (unsigned i = 0; i < count; ++i)
+            {
+                Statement(out, 2, 2);
+            }
+            out += "    end procedure;\n";
+            procedures_ += 1;
+        }
+
+        void Footer(std::string& out)
+        {
+            out += "begin\n    total := 0;\n    return;\nend program\n";
+        }
+
+    private:
+        unsigned Uniform(unsigned lo, unsigned hi)
+        {
+            return std::uniform_int_distribution<unsigned>(lo, hi)(rng_);
+        }
+
+        void Statement(std::string& out, unsigned indent, unsigned depth)
+        {
+            out.append(4 * indent, ' ');
+            unsigned pick = depth == 0 ? Uniform(0, 5) : Uniform(0, 9);
+
+            if (pick < 3)
+            {
+                out += pick == 0 ? "y[x + 1]" : pick == 1 ? "x" : "c";
+                out += " := ";
+                Expression(out, 2);
+            }
+            else if (pick < 5 && procedures_ > 0)
+            {
+                out += "p" + std::to_string(Uniform(0, procedures_ - 1)) + "(";
+                Expression(out, 1);
+                out += ", ";
+                Expression(out, 1);
+                out += ", x)";
+            }
+            else if (pick < 6)
+            {
+                out += Uniform(0, 3) == 0 ? "return" : "f := not x < a";
+            }
+            else if (pick < 8)
+            {
+                out += "if (";
+                Expression(out, 2);
+                out += ") then\n";
+                Block(out, indent, depth);
+                if (Uniform(0, 1))
+                {
+                    out.append(4 * indent, ' ');
+                    out += "else\n";
+                    Block(out, indent, depth);
+                }
+                out.append(4 * indent, ' ');
+                out += "end if";
+            }
+            else
+            {
+                out += "for (x := 0; x < " + std::to_string(Uniform(1, 100)) + ")\n";
+                Block(out, indent, depth);
+                out.append(4 * indent, ' ');
+                out += "end for";
+            }
+            out += ";\n";
+        }
+
+        void Block(std::string& out, unsigned indent, unsigned depth)
+        {
+            unsigned count = Uniform(1, 3);
+            for (unsigned i = 0; i < count; ++i)
+            {
+                Statement(out, indent + 1, depth - 1);
+            }
+        }
+
+        void Expression(std::string& out, unsigned depth)
+        {
+            static const char* const operators[] = {
+                " + ", " - ", " * ", " / ", " < ", " <= ", " > ", " >= ", " == ", " != ", " & ", " | ",
+            };
+
+            Factor(out, depth);
+            unsigned count = Uniform(0, 3);
+            for (unsigned i = 0; i < count; ++i)
+            {
+                out += operators[Uniform(0, sizeof(operators) / sizeof(operators[0]) - 1)];
+                Factor(out, depth);
+            }
+        }
+
+        void Factor(std::string& out, unsigned depth)
+        {
+            switch (Uniform(0, depth > 0 ? 8 : 6))
+            {
+            case 0: out += "a"; break;
+            case 1: out += "-b"; break;
+            case 2: out += std::to_string(Uniform(0, 100000)); break;
+            case 3: out += std::to_string(Uniform(0, 1000)) + "." + std::to_string(Uniform(0, 99)); break;
+            case 4: out += Uniform(0, 1) ? "true" : "false"; break;
+            case 5: out += "\"some text\""; break;
+            case 6: out += "total"; break;
+            case 7:
+                out += "samples[";
+                Expression(out, depth - 1);
+                out += "]";
+                break;
+            default:
+                out += "(";
+                Expression(out, depth - 1);
+                out += ")";
+                break;
+            }
+        }
+
+        std::mt19937 rng_;
+        unsigned procedures_;
+    };
+
+    std::string GenerateProgram(std::size_t bytes, std::uint32_t seed)
+    {
+        ProgramWriter writer(seed);
+
+        std::string out;
+        out.reserve(bytes + 4096);
+        writer.Header(out);
+        while (out.size() < bytes)
+        {
+            writer.Procedure(out);
+        }
+        writer.Footer(out);
+        return out;
+    }
+
+    std::string GenerateCorpus(const CorpusMix& mix, std::size_t bytes, std::uint32_t seed)
+    {
+        CorpusWriter writer(mix, seed);
+
+        std::string out;
+        out.reserve(bytes + 256);
+        while (out.size() < bytes)
+        {
+            writer.Line(out);
+        }
+        return out;
+    }
+}
@@ -0,0 +1,50 @@
+// llc is a compiler for a toy language
+// Copyright (C) 2014  Logan Romantic
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+#ifndef COMPILER_BENCH_CORPUS_H_
+#define COMPILER_BENCH_CORPUS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace llc
+{
+    // Relative weights of what the generator emits. Lines are indented and
+    // hold a handful of items each; comments always run to the end of a line.
+    struct CorpusMix
+    {
+        const char* name;
+        unsigned identifiers;
+        unsigned keywords;
+        unsigned numbers;
+        unsigned strings;
+        unsigned comments;
+        unsigned operators;
+    };
+
+    extern const CorpusMix kCorpusMixes[];
+    extern const std::size_t kCorpusMixCount;
+
+    const CorpusMix* FindCorpusMix(const std::string& name);
+    std::string GenerateCorpus(const CorpusMix& mix, std::size_t bytes, std::uint32_t seed = 1);
+
+    // A syntactically valid program of at least the given size: a run of
+    // procedures with locals, nested control flow and calls, for parsing.
+    std::string GenerateProgram(std::size_t bytes, std::uint32_t seed = 1);
+}
+
+#endif
@@ -0,0 +1,121 @@
+// llc is a compiler for a toy language
+// Copyright (C) 2014  Logan Romantic
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "corpus.h"
+
+// Writes a synthetic program to stdout:
+//
+//   gencorpus [--mix=NAME] [--size=BYTES] [--seed=N]
+//             [--identifiers=W] [--keywords=W] [--numbers=W]
+//             [--strings=W] [--comments=W] [--operators=W]
+//   gencorpus --program [--size=BYTES] [--seed=N]
+//
+// --mix picks one of the presets in corpus.cpp, the weight flags override
+// single entries of it. --program writes a valid program for the parser
+// instead of a token soup.
+
+bool ParseUnsigned(const std::string& arg, const std::string& flag, unsigned long& value)
+{
+    std::string prefix = flag + "=";
+    if (arg.compare(0, prefix.size(), prefix) != 0)
+    {
+        return false;
+    }
+    value = std::strtoul(arg.c_str() + prefix.size(), nullptr, 10);
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    llc::CorpusMix mix = llc::kCorpusMixes[0];
+    unsigned long size = 1 << 20;
+    unsigned long seed = 1;
+    bool program = false;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        unsigned long value;
+
+        if (arg.compare(0, 6, "--mix=") == 0)
+        {
+            const llc::CorpusMix* preset = llc::FindCorpusMix(arg.substr(6));
+            if (preset == nullptr)
+            {
+                std::cerr << "Unknown mix '" << arg.substr(6) << "'" << std::endl;
+                return 1;
+            }
+            mix = *preset;
+        }
+        else if (arg == "--program")
+        {
+            program = true;
+        }
+        else if (ParseUnsigned(arg, "--size", value))
+        {
+            size = value;
+        }
+        else if (ParseUnsigned(arg, "--seed", value))
+        {
+            seed = value;
+        }
+        else if (ParseUnsigned(arg, "--identifiers", value))
+        {
+            mix.identifiers = value;
+        }
+        else if (ParseUnsigned(arg, "--keywords", value))
+        {
+            mix.keywords = value;
+        }
+        else if (ParseUnsigned(arg, "--numbers", value))
+        {
+            mix.numbers = value;
+        }
+        else if (ParseUnsigned(arg, "--strings", value))
+        {
+            mix.strings = value;
+        }
+        else if (ParseUnsigned(arg, "--comments", value))
+        {
+            mix.comments = value;
+        }
+        else if (ParseUnsigned(arg, "--operators", value))
+        {
+            mix.operators = value;
+        }
+        else
+        {
+            std::cerr << "Unknown option '" << arg << "'" << std::endl;
+            return 1;
+        }
+    }
+
+    if (mix.identifiers + mix.keywords + mix.numbers + mix.strings + mix.comments + mix.operators == 0)
+    {
+        std::cerr << "All weights are zero" << std::endl;
+        return 1;
+    }
+
+    std::string corpus = program
+        ? llc::GenerateProgram(size, static_cast<std::uint32_t>(seed))
+        : llc::GenerateCorpus(mix, size, static_cast<std::uint32_t>(seed));
+    std::fwrite(corpus.data(), 1, corpus.size(), stdout);
+    return 0;
+}
@@ -0,0 +1,266 @@
+// llc is a compiler for a toy language
+// Copyright (C) 2014  Logan Romantic
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include <benchmark/benchmark.h>
+#include "corpus.h"
+#include "dump.h"
+#include "parser.h"
+#include "scanner.h"
+
+// Lexer throughput benchmarks. Every benchmark taking a mix argument runs
+// once per preset in corpus.cpp over an in-memory corpus of kCorpusBytes,
+// and reports bytes/s plus tokens/s. BM_Parse runs the parser over a
+// generated program of the same size instead.
+
+using llc::Scanner;
+using llc::Token;
+using llc::TokenType;
+
+const std::size_t kCorpusBytes = 8 << 20;
+
+struct Corpus
+{
+    std::string text;
+    std::string path;
+    std::size_t tokens;
+
+    ~Corpus()
+    {
+        if (!path.empty())
+        {
+            std::remove(path.c_str());
+        }
+    }
+};
+
+std::size_t CountTokens(const std::string& text)
+{
+    Scanner scanner;
+    scanner.AttachBuffer(text.data(), text.size());
+    return scanner.ScanAll().size();
+}
+
+//Multi-threaded benchmarks can be the first to ask for a corpus, so every
+//thread of the run may get here at once
+std::mutex corpus_mutex;
+
+const Corpus& GetCorpus(std::size_t mix)
+{
+    static std::vector<std::unique_ptr<Corpus>> corpora(llc::kCorpusMixCount);
+
+    std::lock_guard<std::mutex> lock(corpus_mutex);
+    std::unique_ptr<Corpus>& corpus = corpora[mix];
+    if (!corpus)
+    {
+        corpus.reset(new Corpus);
+        corpus->text = llc::GenerateCorpus(llc::kCorpusMixes[mix], kCorpusBytes);
+        corpus->tokens = CountTokens(corpus->text);
+    }
+    return *corpus;
+}
+
+//The pipeline benchmark reads from disk like the driver does
+const std::string& GetCorpusFile(std::size_t mix)
+{
+    Corpus& corpus = const_cast<Corpus&>(GetCorpus(mix));
+    std::lock_guard<std::mutex> lock(corpus_mutex);
+    if (corpus.path.empty())
+    {
+        char path[] = "/tmp/llc-bench-XXXXXX";
+        int fd = ::mkstemp(path);
+        if (fd < 0 || ::write(fd, corpus.text.data(), corpus.text.size()) != static_cast<ssize_t>(corpus.text.size()))
+        {
+            std::perror("llc-bench");
+            std::exit(1);
+        }
+        ::close(fd);
+        corpus.path = path;
+    }
+    return corpus.path;
+}
+
+void SetThroughput(benchmark::State& state, const Corpus& corpus)
+{
+    state.SetLabel(llc::kCorpusMixes[state.range(0)].name);
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * corpus.text.size()));
+    state.counters["tokens/s"] = benchmark::Counter(static_cast<double>(corpus.tokens),
+        benchmark::Counter::kIsIterationInvariantRate);
+}
+
+template <typename Policy>
+void ScanTokens(benchmark::State& state, llc::ScanEngine engine)
+{
+    const Corpus& corpus = GetCorpus(state.range(0));
+    Scanner scanner;
+    scanner.set_engine(engine);
+
+    for (auto _ : state)
+    {
+        scanner.AttachBuffer(corpus.text.data(), corpus.text.size());
+        for (Token t = scanner.ScanWith<Policy>(); t.type != TokenType::Eof; t = scanner.ScanWith<Policy>())
+        {
+            benchmark::DoNotOptimize(t);
+        }
+    }
+    SetThroughput(state, corpus);
+}
+
+void BM_Scan(benchmark::State& state)
+{
+    ScanTokens<llc::DefaultScanPolicy>(state, llc::ScanEngine::Handwritten);
+}
+
+//What a parser asks for: no Comment tokens at all
+void BM_ScanCode(benchmark::State& state)
+{
+    ScanTokens<llc::CodeScanPolicy>(state, llc::ScanEngine::Handwritten);
+}
+
+//The same through the table-driven engine, for A/B comparison
+void BM_ScanDfa(benchmark::State& state)
+{
+    ScanTokens<llc::DefaultScanPolicy>(state, llc::ScanEngine::Dfa);
+}
+
+//One long-lived scanner per thread, reset for every input like a service would
+void BM_ScanReset(benchmark::State& state)
+{
+    const Corpus& corpus = GetCorpus(state.range(0));
+    Scanner scanner;
+
+    for (auto _ : state)
+    {
+        scanner.Reset(corpus.text.data(), corpus.text.size());
+        for (Token t = scanner.Scan(); t.type != TokenType::Eof; t = scanner.Scan())
+        {
+            benchmark::DoNotOptimize(t);
+        }
+    }
+    SetThroughput(state, corpus);
+}
+
+void BM_ScanAll(benchmark::State& state)
+{
+    const Corpus& corpus = GetCorpus(state.range(0));
+    Scanner scanner;
+
+    for (auto _ : state)
+    {
+        scanner.AttachBuffer(corpus.text.data(), corpus.text.size());
+        llc::TokenStream tokens = scanner.ScanAll();
+        benchmark::DoNotOptimize(tokens.size());
+    }
+    SetThroughput(state, corpus);
+}
+
+//Scanner + dump, as src/main.cpp does for one file, minus the final write
+void BM_Pipeline(benchmark::State& state)
+{
+    const std::string& path = GetCorpusFile(state.range(0));
+    const Corpus& corpus = GetCorpus(state.range(0));
+    llc::TokenDumper dumper(llc::DumpFormat::Text);
+
+    for (auto _ : state)
+    {
+        dumper.buffer().clear();
+        dumper.BeginFile(path);
+
+        Scanner scanner(path);
+        llc::TokenStream tokens = scanner.ScanAllParallel(1);
+        dumper.DumpTokens(tokens);
+        dumper.DumpDiagnostics(scanner);
+        benchmark::DoNotOptimize(dumper.buffer().data());
+    }
+    SetThroughput(state, corpus);
+}
+
+//Scanner + parser into a fresh arena, as src/main.cpp does with --parse
+void BM_Parse(benchmark::State& state)
+{
+    static const std::string program = llc::GenerateProgram(kCorpusBytes);
+    static const std::size_t tokens = CountTokens(program);
+
+    for (auto _ : state)
+    {
+        Scanner scanner;
+        scanner.AttachBuffer(program.data(), program.size());
+        llc::Arena arena;
+        llc::Parser parser(scanner, arena);
+        benchmark::DoNotOptimize(parser.ParseProgram());
+        if (parser.has_errors())
+        {
+            state.SkipWithError("generated program does not parse");
+            break;
+        }
+    }
+    state.SetLabel("program");
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * program.size()));
+    state.counters["tokens/s"] = benchmark::Counter(static_cast<double>(tokens),
+        benchmark::Counter::kIsIterationInvariantRate);
+}
+
+void BM_LookupIdentifier(benchmark::State& state)
+{
+    const Corpus& corpus = GetCorpus(state.range(0));
+
+    std::vector<std::string_view> words;
+    Scanner scanner;
+    scanner.AttachBuffer(corpus.text.data(), corpus.text.size());
+    for (Token t = scanner.Scan(); t.type != TokenType::Eof; t = scanner.Scan())
+    {
+        if (t.type == TokenType::Identifier || Token::LookupIdentifier(t.value) != TokenType::Identifier)
+        {
+            words.push_back(t.value);
+        }
+    }
+
+    for (auto _ : state)
+    {
+        for (std::string_view word : words)
+        {
+            benchmark::DoNotOptimize(Token::LookupIdentifier(word));
+        }
+    }
+    state.SetLabel(llc::kCorpusMixes[state.range(0)].name);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * words.size()));
+}
+
+void AllMixes(benchmark::internal::Benchmark* b)
+{
+    for (std::size_t i = 0; i < llc::kCorpusMixCount; ++i)
+    {
+        b->Arg(static_cast<int64_t>(i));
+    }
+    b->Unit(benchmark::kMillisecond);
+}
+
+BENCHMARK(BM_Scan)->Apply(AllMixes);
+BENCHMARK(BM_ScanDfa)->Apply(AllMixes);
+BENCHMARK(BM_ScanCode)->Apply(AllMixes);
+BENCHMARK(BM_ScanReset)->Apply(AllMixes)->ThreadRange(1, 4);
+BENCHMARK(BM_ScanAll)->Apply(AllMixes);
+BENCHMARK(BM_Pipeline)->Apply(AllMixes);
+BENCHMARK(BM_Parse)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_LookupIdentifier)->Arg(1)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
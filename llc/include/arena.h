@@ -0,0 +1,69 @@
+// llc is a compiler for a toy language
+// Copyright (C) 2014  Logan Romantic
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+#ifndef COMPILER_ARENA_H_
+#define COMPILER_ARENA_H_
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace llc
+{
+    // Bump allocator. Memory comes from large blocks and is only given back
+    // all at once by Clear() or the destructor; nothing allocated here has
+    // its destructor run. Reset() drops everything too but keeps the first
+    // block, so an arena refilled with a similar amount each round stops
+    // calling the system allocator.
+    class Arena
+    {
+    public:
+        static const std::size_t kDefaultBlockSize = 64 * 1024;
+
+        Arena(std::size_t block_size = kDefaultBlockSize);
+
+        Arena(const Arena&) = delete;
+        Arena& operator=(const Arena&) = delete;
+        Arena(Arena&&) = default;
+        Arena& operator=(Arena&&) = default;
+
+        void* Allocate(std::size_t size, std::size_t align = alignof(std::max_align_t));
+        std::string_view Copy(std::string_view bytes);
+        void Clear();
+        void Reset();
+
+        template <typename T, typename... Args>
+        T* New(Args&&... args)
+        {
+            return new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        }
+
+        std::size_t allocated() const { return allocated_; }
+
+    private:
+        std::size_t block_size_;
+        std::size_t first_block_size_;
+        std::vector<std::unique_ptr<char[]>> blocks_;
+        char* next_;
+        char* end_;
+        std::size_t allocated_;
+    };
+}
+
+#endif
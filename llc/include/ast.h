@@ -0,0 +1,123 @@
+// llc is a compiler for a toy language
+// Copyright (C) 2014  Logan Romantic
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+#ifndef COMPILER_AST_H_
+#define COMPILER_AST_H_
+
+#include <cstdint>
+#include <string_view>
+#include "token.h"
+
+namespace llc
+{
+    // Syntax tree built by Parser. Nodes are placed in an Arena and only
+    // hold pointers to other nodes, views into the source and interned
+    // symbols, so they are never destroyed one by one: clearing or dropping
+    // the arena releases a whole tree at once. Sibling lists (declarations,
+    // parameters, statements, arguments) are chained through next.
+    //
+    // Every node starts zeroed; offset is where its first token starts.
+    // After a syntax error the affected child pointers may be null.
+
+    enum class ExprKind : std::uint8_t
+    {
+        Binary,
+        Negate,
+        Not,
+        Name,
+        Integer,
+        Float,
+        String,
+        Bool,
+    };
+
+    struct Expr
+    {
+        ExprKind kind;
+        TokenType op;           //Binary: the operator
+        std::uint32_t offset;
+        std::uint32_t symbol;   //Name, String: interned value
+        std::string_view text;  //Name: the identifier; literals: their source text
+        LiteralValue literal;   //Integer, Float; Bool: integer 0 or 1
+        Expr* left;             //Binary: left operand; Negate, Not: operand; Name: index or null
+        Expr* right;            //Binary: right operand
+        Expr* next;
+    };
+
+    enum class StmtKind : std::uint8_t
+    {
+        Assign,
+        If,
+        For,
+        Return,
+        Call,
+    };
+
+    struct Stmt
+    {
+        StmtKind kind;
+        std::uint32_t offset;
+        std::uint32_t symbol;   //Call: the procedure
+        std::string_view name;  //Call: the procedure
+        Expr* target;           //Assign: destination Name
+        Expr* value;            //Assign: value; If, For: condition
+        Expr* args;             //Call
+        Stmt* init;             //For: the initial assignment
+        Stmt* body;             //If: then branch; For: loop body
+        Stmt* else_body;        //If
+        Stmt* next;
+    };
+
+    enum class DeclKind : std::uint8_t
+    {
+        Variable,
+        Procedure,
+    };
+
+    enum class ParamMode : std::uint8_t
+    {
+        None,
+        In,
+        Out,
+    };
+
+    struct Decl
+    {
+        DeclKind kind;
+        bool global;
+        ParamMode mode;         //Parameters only
+        TokenType type_mark;    //Variable: IntegerType, FloatType, BoolType or StringType
+        std::uint32_t offset;
+        std::uint32_t symbol;
+        std::string_view name;
+        Expr* bound;            //Variable: array size, null for scalars
+        Decl* params;           //Procedure
+        Decl* decls;            //Procedure: local declarations
+        Stmt* body;             //Procedure
+        Decl* next;
+    };
+
+    struct Program
+    {
+        std::uint32_t offset;
+        std::uint32_t symbol;
+        std::string_view name;
+        Decl* decls;
+        Stmt* body;
+    };
+}
+
+#endif
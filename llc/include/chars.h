@@ -0,0 +1,87 @@
+// llc is a compiler for a toy language
+// Copyright (C) 2014  Logan Romantic
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+#ifndef COMPILER_CHARS_H_
+#define COMPILER_CHARS_H_
+
+#include <cstdint>
+#include <initializer_list>
+
+namespace llc
+{
+    // Character classes of the toy language. A byte may belong to several
+    // classes; bytes above 127 belong to none.
+    enum CharClass : std::uint8_t
+    {
+        kIdentStart = 1 << 0,
+        kIdentContinue = 1 << 1,
+        kDigit = 1 << 2,
+        kNumberContinue = 1 << 3,
+        kWhitespace = 1 << 4,
+        kSymbolStart = 1 << 5,
+        kStringChar = 1 << 6,
+    };
+
+    struct CharClassTable
+    {
+        std::uint8_t classes[256];
+    };
+
+    constexpr CharClassTable hBuildCharClassTable()
+    {
+        CharClassTable table = {};
+
+        for (int c = 'a'; c <= 'z'; ++c)
+        {
+            table.classes[c] |= kIdentStart | kIdentContinue | kStringChar;
+            table.classes[c - 'a' + 'A'] |= kIdentStart | kIdentContinue | kStringChar;
+        }
+        for (int c = '0'; c <= '9'; ++c)
+        {
+            table.classes[c] |= kDigit | kNumberContinue | kIdentContinue | kStringChar;
+        }
+        table.classes[static_cast<unsigned char>('_')] |= kIdentContinue | kNumberContinue;
+
+        for (char c : {' ', '\t', '\n', '\v', '\f', '\r'})
+        {
+            table.classes[static_cast<unsigned char>(c)] |= kWhitespace;
+        }
+        for (char c : {';', ',', '(', ')', '[', ']', ':', '|', '&', '+', '-', '*', '/', '<', '>', '=', '!'})
+        {
+            table.classes[static_cast<unsigned char>(c)] |= kSymbolStart;
+        }
+        for (char c : {' ', '_', ',', ';', ':', '.', '\''})
+        {
+            table.classes[static_cast<unsigned char>(c)] |= kStringChar;
+        }
+
+        return table;
+    }
+
+    constexpr CharClassTable char_classes = hBuildCharClassTable();
+
+    inline std::uint8_t ClassOf(char c)
+    {
+        return char_classes.classes[static_cast<unsigned char>(c)];
+    }
+
+    inline bool HasClass(char c, CharClass cls)
+    {
+        return (ClassOf(c) & cls) != 0;
+    }
+}
+
+#endif
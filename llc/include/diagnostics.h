@@ -0,0 +1,87 @@
+// llc is a compiler for a toy language
+// Copyright (C) 2014  Logan Romantic
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+#ifndef COMPILER_DIAGNOSTICS_H_
+#define COMPILER_DIAGNOSTICS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "span.h"
+
+namespace llc
+{
+    enum class DiagCode : std::uint8_t
+    {
+        UnexpectedChar,
+        CharNotAllowed,
+        UnterminatedString,
+        NumberOutOfRange,
+        TooManyDiagnostics,
+        ExpectedToken,
+        UnexpectedToken,
+    };
+
+    enum class Severity : std::uint8_t
+    {
+        Warning,
+        Error,
+    };
+
+    // One reported problem. The message is not stored; it is rebuilt from
+    // the code and the offending byte only when somebody prints it. For the
+    // parser's codes arg holds a TokenType instead.
+    struct Diagnostic
+    {
+        std::uint32_t offset;
+        DiagCode code;
+        char arg;
+    };
+
+    // Diagnostics of one scan, in report order (non-decreasing offsets).
+    // Records are plain values in one contiguous block that Clear() keeps
+    // for reuse, so reporting never allocates once the block has grown.
+    class Diagnostics
+    {
+    public:
+        Diagnostics();
+
+        void Report(DiagCode code, std::uint32_t offset, char arg = 0);
+        void Append(Span<const Diagnostic> records, std::int64_t shift = 0);
+        void Truncate(std::size_t count);
+        void Clear();
+
+        // Index of the first record at or after offset.
+        std::size_t LowerBound(std::uint32_t offset) const;
+
+        Span<const Diagnostic> records() const { return Span<const Diagnostic>(records_.data(), records_.size()); }
+        std::size_t size() const { return records_.size(); }
+        bool empty() const { return records_.empty(); }
+        std::size_t warning_count() const { return counts_[static_cast<int>(Severity::Warning)]; }
+        std::size_t error_count() const { return counts_[static_cast<int>(Severity::Error)]; }
+
+        static Severity SeverityOf(DiagCode code);
+        static void Format(const Diagnostic& diagnostic, std::string& out);
+        static std::string Message(const Diagnostic& diagnostic);
+
+    private:
+        std::vector<Diagnostic> records_;
+        std::size_t counts_[2];
+    };
+}
+
+#endif
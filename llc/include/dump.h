@@ -0,0 +1,87 @@
+// llc is a compiler for a toy language
+// Copyright (C) 2014  Logan Romantic
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+#ifndef COMPILER_DUMP_H_
+#define COMPILER_DUMP_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include "scanner.h"
+#include "token_stream.h"
+
+namespace llc
+{
+    enum class DumpFormat : std::uint8_t
+    {
+        Text,
+        Binary,
+    };
+
+    // Formats scanner output into one large reusable buffer. With a sink the
+    // buffer is written out whenever it passes the flush threshold and on
+    // Flush(); without one it simply grows and the caller takes buffer().
+    //
+    // Text is the classic "NAME value" line per token followed by one line
+    // per diagnostic. Binary is, per file, all integers little-endian:
+    //
+    //   "LLCT" u8 version u32 path_length path
+    //   u32 token_count   { u8 type u32 value_offset u32 value_length }*
+    //   u32 diagnostic_count { u32 offset u32 line u32 column u32 length message }*
+    //
+    // Token values are not copied; value_offset indexes the source file.
+    // The trailing Eof token is not written in either format. A file that
+    // could not be read gets zero counts.
+    class TokenDumper
+    {
+    public:
+        static const std::uint8_t kBinaryVersion = 1;
+
+        TokenDumper(DumpFormat format, std::FILE* sink = nullptr);
+        ~TokenDumper();
+
+        TokenDumper(const TokenDumper&) = delete;
+        TokenDumper& operator=(const TokenDumper&) = delete;
+
+        void BeginFile(std::string_view path);
+        void DumpTokens(const TokenStream& tokens);
+        void DumpDiagnostics(const Scanner& scanner);
+        void DumpUnreadable();
+        void Flush();
+
+        // Text format only: one token or diagnostic line at a time, for
+        // scanners that never hold a whole TokenStream.
+        void DumpToken(const Token& token);
+        void DumpDiagnostic(const Diagnostic& diagnostic, Coord coord);
+
+        std::string& buffer() { return buffer_; }
+
+    private:
+        void Put(std::string_view bytes) { buffer_.append(bytes.data(), bytes.size()); }
+        void PutU8(std::uint8_t value) { buffer_.push_back(static_cast<char>(value)); }
+        void PutU32(std::uint32_t value);
+        void PutInt(int value);
+        void MaybeFlush();
+
+        DumpFormat format_;
+        std::FILE* sink_;
+        std::string buffer_;
+        std::string message_;
+    };
+}
+
+#endif
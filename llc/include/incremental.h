@@ -0,0 +1,69 @@
+// llc is a compiler for a toy language
+// Copyright (C) 2014  Logan Romantic
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+#ifndef COMPILER_INCREMENTAL_H_
+#define COMPILER_INCREMENTAL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "line_index.h"
+#include "scanner.h"
+#include "token_stream.h"
+
+namespace llc
+{
+    struct TextEdit
+    {
+        std::uint32_t offset;
+        std::uint32_t removed;
+        std::string inserted;
+    };
+
+    // Owns an editable buffer and keeps its token stream and diagnostics up to
+    // date. Apply() re-lexes from the last token starting before the edit
+    // until a new token starts where an old one did past the edit; the
+    // scanner keeps no state between tokens, so everything after that point
+    // is reused with its offsets shifted. The result always matches a full
+    // scan of the edited text.
+    class IncrementalLexer
+    {
+    public:
+        IncrementalLexer();
+
+        void Reset(std::string text);
+        bool Apply(const TextEdit& edit);
+
+        const std::string& text() const { return text_; }
+        const TokenStream& tokens() const { return tokens_; }
+        const Diagnostics& diagnostics() const { return diagnostics_; }
+        const Interner& interner() const { return interner_; }
+        Coord Locate(std::uint32_t offset) const;
+
+        // Tokens scanned by the last Reset or Apply.
+        std::size_t relexed() const { return relexed_; }
+
+    private:
+        std::string text_;
+        TokenStream tokens_;
+        Diagnostics diagnostics_;
+        Interner interner_;
+        mutable LineIndex lines_;
+        std::size_t relexed_;
+    };
+}
+
+#endif
@@ -0,0 +1,73 @@
+// llc is a compiler for a toy language
+// Copyright (C) 2014  Logan Romantic
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+#ifndef COMPILER_INTERNER_H_
+#define COMPILER_INTERNER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "arena.h"
+#include "token.h"
+
+namespace llc
+{
+    // Maps each distinct name to a dense 32-bit symbol ID, handed out in
+    // order of first appearance. Names are copied into an arena, so IDs and
+    // Name() views stay valid after the source buffer is gone. Lookup is an
+    // open-addressing table with linear probing over the IDs.
+    class Interner
+    {
+    public:
+        static constexpr std::uint32_t kNoSymbol = 0xFFFFFFFFu;
+
+        Interner();
+
+        std::uint32_t Intern(std::string_view name);
+        std::uint32_t Find(std::string_view name) const;
+        // Forgets every symbol from count on, as if they were never interned.
+        // Their names stay in the arena until Clear().
+        void Truncate(std::size_t count);
+        // Forgets every name but keeps the table and some name storage for
+        // the next round.
+        void Clear();
+
+        std::string_view Name(std::uint32_t symbol) const { return entries_[symbol].name; }
+        std::size_t size() const { return entries_.size(); }
+
+    private:
+        struct Entry
+        {
+            std::string_view name;
+            std::uint32_t hash;
+        };
+
+        void Grow();
+
+        Arena names_;
+        std::vector<Entry> entries_;
+        std::vector<std::uint32_t> slots_;
+    };
+
+    //Tokens whose value is interned
+    inline bool IsSymbolToken(TokenType type)
+    {
+        return type == TokenType::Identifier || type == TokenType::String;
+    }
+}
+
+#endif
@@ -0,0 +1,48 @@
+// llc is a compiler for a toy language
+// Copyright (C) 2014  Logan Romantic
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+#ifndef COMPILER_LINE_INDEX_H_
+#define COMPILER_LINE_INDEX_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "token.h"
+
+namespace llc
+{
+    // Offsets at which each line of a buffer starts. Lines are 1-based and
+    // columns count bytes from 1, matching what the scanner used to track
+    // per character.
+    class LineIndex
+    {
+    public:
+        LineIndex();
+
+        void Build(const char* data, std::size_t size);
+        void Clear();
+        bool built() const { return built_; }
+
+        Coord Locate(std::uint32_t offset) const;
+        std::size_t lines() const { return starts_.size(); }
+
+    private:
+        bool built_;
+        std::vector<std::uint32_t> starts_;
+    };
+}
+
+#endif
@@ -0,0 +1,56 @@
+// llc is a compiler for a toy language
+// Copyright (C) 2014  Logan Romantic
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+#ifndef COMPILER_LITERALS_H_
+#define COMPILER_LITERALS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "token.h"
+
+namespace llc
+{
+    // Side table of pre-parsed literal values, indexed by PackedToken::aux.
+    // It holds at most kNoAux entries; Add() returns kNoAux once full.
+    class LiteralTable
+    {
+    public:
+        std::uint32_t Add(LiteralValue value);
+        void Resize(std::size_t count);
+        void Set(std::uint32_t index, LiteralValue value) { values_[index] = value; }
+        void Clear() { values_.clear(); }
+
+        std::size_t size() const { return values_.size(); }
+        LiteralValue operator[](std::uint32_t index) const { return values_[index]; }
+
+    private:
+        std::vector<LiteralValue> values_;
+    };
+
+    // Parses the text of an Integer or Float token, skipping '_' separators.
+    // Fails for other types and for values that do not fit. The scanner
+    // already does this; it is for tokens whose value was not kept.
+    bool DecodeLiteral(TokenType type, std::string_view text, LiteralValue& value);
+
+    inline bool IsNumberLiteral(TokenType type)
+    {
+        return type == TokenType::Integer || type == TokenType::Float;
+    }
+}
+
+#endif
@@ -0,0 +1,36 @@
+// llc is a compiler for a toy language
+// Copyright (C) 2014  Logan Romantic
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+#ifndef COMPILER_PARALLEL_FOR_H_
+#define COMPILER_PARALLEL_FOR_H_
+
+#include <cstddef>
+#include <functional>
+
+namespace llc
+{
+    // Number of workers to use when the caller asks for 0.
+    unsigned DefaultWorkerCount();
+
+    // Calls work(i) for every i in [0, count) on up to `workers` threads
+    // (the calling thread included) and returns once all calls finished.
+    // Items are handed out in increasing order. The extra threads are
+    // started for this call and joined before it returns; there is no
+    // long-lived pool.
+    void ParallelFor(std::size_t count, unsigned workers, const std::function<void(std::size_t)>& work);
+}
+
+#endif
@@ -0,0 +1,117 @@
+// llc is a compiler for a toy language
+// Copyright (C) 2014  Logan Romantic
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+#ifndef COMPILER_PARSER_H_
+#define COMPILER_PARSER_H_
+
+#include <cstddef>
+#include "arena.h"
+#include "ast.h"
+#include "diagnostics.h"
+#include "scanner.h"
+#include "token_pipeline.h"
+
+namespace llc
+{
+    // LL(1) recursive descent parser for the toy language:
+    //
+    //   program     ::= "program" IDENT "is" body "program"
+    //   body        ::= (declaration ";")* "begin" (statement ";")* "end"
+    //   declaration ::= ["global"] (procedure | variable)
+    //   procedure   ::= "procedure" IDENT "(" [parameter ("," parameter)*] ")" body "procedure"
+    //   parameter   ::= variable ("in" | "out")
+    //   variable    ::= type_mark IDENT ["[" INT "]"]
+    //   statement   ::= name ":=" expression | IDENT "(" [arguments] ")"
+    //                 | "if" "(" expression ")" "then" (statement ";")+
+    //                   ["else" (statement ";")+] "end" "if"
+    //                 | "for" "(" name ":=" expression ";" expression ")"
+    //                   (statement ";")* "end" "for"
+    //                 | "return"
+    //   expression  ::= ["not"] arith (("&" | "|") arith)*
+    //   arith       ::= relation (("+" | "-") relation)*
+    //   relation    ::= term (("<" | "<=" | ">" | ">=" | "==" | "!=") term)*
+    //   term        ::= factor (("*" | "/") factor)*
+    //   factor      ::= "(" expression ")" | ["-"] name | ["-"] (INT | FLOAT)
+    //                 | STRING | "true" | "false"
+    //   name        ::= IDENT ["[" expression "]"]
+    //
+    // Tokens are pulled on demand, from a scanner (which then skips comments
+    // itself) or from a TokenPipeline scanning on another thread, through a
+    // small ring of lookahead that drops any remaining comments and the
+    // illegal tokens the scanner has already reported. Nodes go to the given
+    // arena, which must outlive the tree, as must the scanner's input and
+    // interner.
+    //
+    // A syntax error is reported once; the parser then skips to the end of
+    // the current declaration or statement and carries on, so ParseProgram
+    // always returns a tree.
+    class Parser
+    {
+    public:
+        static const std::size_t kLookahead = 4;
+
+        Parser(Scanner& scanner, Arena& arena);
+        Parser(TokenPipeline& pipeline, Arena& arena);
+
+        Parser(const Parser&) = delete;
+        Parser& operator=(const Parser&) = delete;
+
+        Program* ParseProgram();
+
+        const Diagnostics& diagnostics() const { return diagnostics_; }
+        bool has_errors() const { return diagnostics_.error_count() != 0; }
+
+    private:
+        const Token& Peek(std::size_t ahead = 0);
+        bool At(TokenType type) { return Peek().type == type; }
+        Token Next();
+        bool Accept(TokenType type);
+        bool Expect(TokenType type);
+        void Report(DiagCode code, TokenType arg);
+        void Synchronize(bool declarations);
+
+        Decl* ParseDeclarations();
+        Decl* ParseDeclaration();
+        Decl* ParseProcedure(bool global, std::uint32_t offset);
+        Decl* ParseVariable(bool global, std::uint32_t offset);
+        void ParseBody(Decl*& decls, Stmt*& body);
+        Stmt* ParseStatements(bool at_least_one);
+        Stmt* ParseStatement();
+        Stmt* ParseIf();
+        Stmt* ParseFor();
+        Stmt* ParseAssignment(Expr* target);
+        Stmt* ParseCall(const Token& name);
+        Expr* ParseExpression();
+        Expr* ParseArith();
+        Expr* ParseRelation();
+        Expr* ParseTerm();
+        Expr* ParseFactor();
+        Expr* ParseName();
+        Expr* NewBinary(TokenType op, Expr* left, Expr* right);
+        Expr* NewLeaf(ExprKind kind, const Token& token);
+
+        Scanner* scanner_;
+        TokenPipeline* pipeline_;
+        Arena& arena_;
+        Token ring_[kLookahead];
+        std::size_t head_;
+        std::size_t count_;
+        bool panic_;
+        Diagnostics diagnostics_;
+    };
+}
+
+#endif
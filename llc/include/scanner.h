@@ -19,60 +19,160 @@
 
 #include <vector>
 #include <memory>
+#include "diagnostics.h"
+#include "interner.h"
+#include "line_index.h"
+#include "source.h"
 #include "token.h"
+#include "token_stream.h"
 
 namespace llc
 {
-    class Warning; 
     class Error;
 
-    typedef std::vector<std::shared_ptr<Warning>> warnings_vector;
+    //The value of Scanner's current character once the input is exhausted
+    inline constexpr char EOF_CHAR = static_cast<char>(-1);
+
     typedef std::vector<std::shared_ptr<Error>> errors_vector;
 
+    class TokenCache;
+
+    // Two implementations of Scan() that produce identical tokens and
+    // diagnostics, kept side by side for A/B comparison. Handwritten
+    // dispatches on the current character and scans each kind of token in
+    // its own routine; Dfa runs every token but strings through one
+    // transition table built at compile time (scanner_table.cpp).
+    enum class ScanEngine : std::uint8_t
+    {
+        Handwritten,
+        Dfa,
+    };
+
+    // Compile-time options for Scanner::ScanWith. Without Comments, comments
+    // are skipped like whitespace instead of becoming Comment tokens; without
+    // Warnings, warning diagnostics are never recorded. Each combination is
+    // its own instantiation, so the choices cost nothing per token.
+    template <bool Comments, bool Warnings>
+    struct ScanPolicy
+    {
+        static constexpr bool kComments = Comments;
+        static constexpr bool kWarnings = Warnings;
+    };
+
+    typedef ScanPolicy<true, true> DefaultScanPolicy;
+    typedef ScanPolicy<false, true> CodeScanPolicy;
+
+    // A Scanner is not thread-safe, but separate scanners share nothing
+    // mutable: the keyword, name and character class tables are constexpr,
+    // the SIMD kernels are picked once by a thread-safe static and stats
+    // counters are per thread. Any number of threads can scan at once as
+    // long as each uses its own scanner (and interner, if one is shared in).
+    // A long-lived thread can keep one scanner and Reset() it per input.
     class Scanner
     {
     public:
+        // Bump whenever the tokens produced for some input change, so that
+        // cached token streams are thrown away.
+        static const std::uint32_t kVersion = 1;
+
         Scanner();
         Scanner(std::string filepath);
         
         ~Scanner();
 
         Token Scan();
+        // Explicitly instantiated in scanner.cpp for every ScanPolicy.
+        template <typename Policy>
+        Token ScanWith();
+        TokenStream ScanAll();
+        TokenStream ScanAllParallel(unsigned workers = 0);
+        TokenStream ScanAllCached(TokenCache& cache, unsigned workers = 0);
         void AttachFile(std::string filepath);
-
-        int line() const { return line_; }
-        int column() const { return column_; }
+        void AttachBuffer(const char* data, std::size_t size, std::size_t start = 0);
+        // AttachBuffer, with the scanner's own interner emptied as well, so
+        // that the next input starts from symbol 0. Settings are kept, and so
+        // is the memory behind diagnostics, the line index and the interner.
+        void Reset(const char* data, std::size_t size);
+
+        Coord Locate(std::uint32_t offset) const;
+        int line() const { return Locate(static_cast<std::uint32_t>(Position())).line; }
+        int column() const { return Locate(static_cast<std::uint32_t>(Position())).column; }
         bool has_errors() const { return has_errors_; }
-        warnings_vector warnings() const { return warnings_; };
+
+        // Stop scanning once this many diagnostics were reported, with a
+        // final note saying so; 0 means no limit.
+        void set_max_diagnostics(std::size_t max) { max_diagnostics_ = max; }
+
+        void set_engine(ScanEngine engine) { engine_ = engine; }
+        ScanEngine engine() const { return engine_; }
+
+        // Identifier and string symbols go to the scanner's own interner
+        // unless another one is shared in; nullptr switches back.
+        void set_interner(Interner* interner) { interner_ = interner ? interner : &own_interner_; }
+        Interner& interner() { return *interner_; }
+        const Interner& interner() const { return *interner_; }
+        const Diagnostics& diagnostics() const { return diagnostics_; }
+        const errors_vector& errors() const { return errors_; }
 
     private:
+        friend class StreamScanner;
+
+        struct Chunk;
+        static void ScanChunk(const char* input, std::size_t begin, std::size_t end, ScanEngine engine, Chunk& chunk);
+
         void NextChar();
         char Peek();
-        void FreezePosition(Coord& coord);
+        bool AtEnd() const { return offset_ > size_; }
+        std::size_t Position() const { return offset_ - 1; }
+        std::string_view Slice(std::size_t start) const;
+        void AdvanceTo(const char* p);
         void SkipWhitespace();
         void ScanComment(Token& token);
+        void SkipComment();
         void ScanIdentifier(Token& token);
-        void ScanNumberPart(std::ostringstream& ss);
+        void ScanNumberPart();
         void ScanNumber(Token& token);
         void ScanString(Token& token);
-		void ScanSymbol(Token& token);
+        template <typename Policy>
+        void ScanSymbol(Token& token);
+        template <typename Policy>
+        void ScanIllegal(Token& token);
+        template <typename Policy>
+        void ScanTable(Token& token);
+        void Report(DiagCode code, std::uint32_t offset, char arg = 0);
+
+        template <typename Policy>
+        void Warn(DiagCode code, std::uint32_t offset, char arg)
+        {
+            if constexpr (Policy::kWarnings)
+            {
+                Report(code, offset, arg);
+            }
+        }
+        void Stop();
 
         void Init();
 
         char char_;
         bool has_errors_;
         unsigned int offset_;
-        int line_;
-        int column_;
-        std::vector<char> input_;
-        warnings_vector warnings_;
+        mutable LineIndex lines_;
+        SourceBuffer source_;
+        const char* input_;
+        std::size_t size_;
+        std::size_t max_diagnostics_;
+        ScanEngine engine_;
+        Interner own_interner_;
+        Interner* interner_;
+        Diagnostics diagnostics_;
+        errors_vector errors_;
     };
 
-    class Warning
+    class Error
     {
     public:
-        Warning(std::string message, Coord coord);
-        ~Warning();
+        Error(std::string message, Coord coord);
+        ~Error();
 
         std::string message() const { return message_; }
         Coord coord() const { return coord_; }
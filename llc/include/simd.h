@@ -0,0 +1,33 @@
+// llc is a compiler for a toy language
+// Copyright (C) 2014  Logan Romantic
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+#ifndef COMPILER_SIMD_H_
+#define COMPILER_SIMD_H_
+
+namespace llc
+{
+    // Run scanners over [p, end). Each returns the first byte that ends the
+    // run, or end. The implementation (AVX2, SSE2 or scalar) is picked once
+    // from the running CPU; LLC_SIMD=avx2|sse2|scalar in the environment
+    // forces a narrower one.
+    const char* SkipWhitespaceRun(const char* p, const char* end);
+    const char* SkipIdentifierRun(const char* p, const char* end);
+    const char* FindNewline(const char* p, const char* end);
+
+    const char* SimdTarget();
+}
+
+#endif
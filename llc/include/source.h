@@ -0,0 +1,58 @@
+// llc is a compiler for a toy language
+// Copyright (C) 2014  Logan Romantic
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+#ifndef COMPILER_SOURCE_H_
+#define COMPILER_SOURCE_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace llc
+{
+    // Read-only view of a source file. Regular files are memory-mapped so
+    // the scanner works straight over the mapped pages; pipes, ttys and
+    // stdin ("-") fall back to buffered reads.
+    class SourceBuffer
+    {
+    public:
+        SourceBuffer();
+        ~SourceBuffer();
+
+        SourceBuffer(const SourceBuffer&) = delete;
+        SourceBuffer& operator=(const SourceBuffer&) = delete;
+
+        bool Open(const std::string& filepath);
+        void Close();
+
+        const char* data() const { return data_; }
+        std::size_t size() const { return size_; }
+        bool is_mapped() const { return map_ != nullptr; }
+        std::string error() const { return error_; }
+
+    private:
+        bool Map(int fd, std::size_t size);
+        bool ReadAll(int fd);
+
+        const char* data_;
+        std::size_t size_;
+        void* map_;
+        std::vector<char> buffer_;
+        std::string error_;
+    };
+}
+
+#endif
@@ -0,0 +1,47 @@
+// llc is a compiler for a toy language
+// Copyright (C) 2014  Logan Romantic
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+#ifndef COMPILER_SPAN_H_
+#define COMPILER_SPAN_H_
+
+#include <cstddef>
+
+namespace llc
+{
+    // Non-owning view of a contiguous run of T, valid until the owner
+    // reallocates.
+    template <typename T>
+    class Span
+    {
+    public:
+        Span() : data_(nullptr), size_(0) {}
+        Span(T* data, std::size_t size) : data_(data), size_(size) {}
+
+        T* begin() const { return data_; }
+        T* end() const { return data_ + size_; }
+        T& operator[](std::size_t i) const { return data_[i]; }
+
+        T* data() const { return data_; }
+        std::size_t size() const { return size_; }
+        bool empty() const { return size_ == 0; }
+
+    private:
+        T* data_;
+        std::size_t size_;
+    };
+}
+
+#endif
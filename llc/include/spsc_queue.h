@@ -0,0 +1,107 @@
+// llc is a compiler for a toy language
+// Copyright (C) 2014  Logan Romantic
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+#ifndef COMPILER_SPSC_QUEUE_H_
+#define COMPILER_SPSC_QUEUE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace llc
+{
+    // Bounded lock-free queue for exactly one producer and one consumer
+    // thread. Slots are preallocated and filled and read in place: the
+    // producer fills the slot from TryAcquire() and hands it over with
+    // Publish(), the consumer reads TryFront() and gives the slot back with
+    // Release(). Each side keeps a cached copy of the other side's index,
+    // so the shared indices are only touched when the queue looks full or
+    // empty.
+    template <typename T>
+    class SpscQueue
+    {
+    public:
+        //capacity is rounded up to a power of two
+        explicit SpscQueue(std::size_t capacity)
+            : head_(0), cached_tail_(0), tail_(0), cached_head_(0)
+        {
+            std::size_t size = 1;
+            while (size < capacity)
+            {
+                size <<= 1;
+            }
+            slots_.reset(new T[size]);
+            mask_ = size - 1;
+        }
+
+        SpscQueue(const SpscQueue&) = delete;
+        SpscQueue& operator=(const SpscQueue&) = delete;
+
+        //Producer: the next free slot, or null while the queue is full
+        T* TryAcquire()
+        {
+            std::size_t head = head_.load(std::memory_order_relaxed);
+            if (head - cached_tail_ > mask_)
+            {
+                cached_tail_ = tail_.load(std::memory_order_acquire);
+                if (head - cached_tail_ > mask_)
+                {
+                    return nullptr;
+                }
+            }
+            return &slots_[head & mask_];
+        }
+
+        void Publish()
+        {
+            head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        //Consumer: the oldest published slot, or null while the queue is empty
+        T* TryFront()
+        {
+            std::size_t tail = tail_.load(std::memory_order_relaxed);
+            if (tail == cached_head_)
+            {
+                cached_head_ = head_.load(std::memory_order_acquire);
+                if (tail == cached_head_)
+                {
+                    return nullptr;
+                }
+            }
+            return &slots_[tail & mask_];
+        }
+
+        void Release()
+        {
+            tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+    private:
+        std::unique_ptr<T[]> slots_;
+        std::size_t mask_;
+
+        //Written by the producer
+        alignas(64) std::atomic<std::size_t> head_;
+        std::size_t cached_tail_;
+
+        //Written by the consumer
+        alignas(64) std::atomic<std::size_t> tail_;
+        std::size_t cached_head_;
+    };
+}
+
+#endif
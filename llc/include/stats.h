@@ -0,0 +1,104 @@
+// llc is a compiler for a toy language
+// Copyright (C) 2014  Logan Romantic
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+#ifndef COMPILER_STATS_H_
+#define COMPILER_STATS_H_
+
+#include <cstdint>
+#include <string>
+#include "token.h"
+
+// Scanner statistics, compiled in only with -DLLC_STATS (make STATS=1).
+// Without it every LLC_STATS_* macro expands to nothing and the hot paths
+// are exactly the uninstrumented code.
+//
+// Each thread counts into its own ScanStats, folded into a global total
+// when the thread exits; StatsJson() reports the total plus the calling
+// thread. Routine times include the cost of reading the clock.
+
+namespace llc
+{
+    enum class StatRoutine : std::uint8_t
+    {
+        SkipWhitespace,
+        ScanComment,
+        ScanIdentifier,
+        ScanNumber,
+        ScanString,
+        ScanSymbol,
+        ScanIllegal,
+        ScanTable,
+    };
+
+    enum class StatPhase : std::uint8_t
+    {
+        Read,
+        Scan,
+        Parse,
+        Dump,
+    };
+
+    const std::size_t kStatRoutineCount = static_cast<std::size_t>(StatRoutine::ScanTable) + 1;
+    const std::size_t kStatPhaseCount = static_cast<std::size_t>(StatPhase::Dump) + 1;
+
+#ifdef LLC_STATS
+    const bool kStatsEnabled = true;
+
+    struct ScanStats
+    {
+        std::uint64_t bytes;
+        std::uint64_t tokens;
+        std::uint64_t token_types[kTokenTypeCount];
+        std::uint64_t routine_calls[kStatRoutineCount];
+        std::uint64_t routine_ns[kStatRoutineCount];
+        std::uint64_t phase_ns[kStatPhaseCount];
+        std::uint64_t keyword_lookups;
+        std::uint64_t keyword_hits;
+    };
+
+    ScanStats& LocalStats();
+    std::uint64_t StatClock();
+    std::string StatsJson();
+
+    class StatTimer
+    {
+    public:
+        StatTimer(StatRoutine routine)
+            : ns_(LocalStats().routine_ns[static_cast<std::size_t>(routine)]), start_(StatClock())
+        {
+            LocalStats().routine_calls[static_cast<std::size_t>(routine)] += 1;
+        }
+        StatTimer(StatPhase phase)
+            : ns_(LocalStats().phase_ns[static_cast<std::size_t>(phase)]), start_(StatClock())
+        {}
+        ~StatTimer() { ns_ += StatClock() - start_; }
+
+    private:
+        std::uint64_t& ns_;
+        std::uint64_t start_;
+    };
+
+#define LLC_STATS_ADD(field, n) (::llc::LocalStats().field += (n))
+#define LLC_STATS_TIME(what) ::llc::StatTimer llc_stat_timer_(what)
+#else
+    const bool kStatsEnabled = false;
+
+#define LLC_STATS_ADD(field, n) ((void)0)
+#define LLC_STATS_TIME(what) ((void)0)
+#endif
+}
+
+#endif
@@ -0,0 +1,81 @@
+// llc is a compiler for a toy language
+// Copyright (C) 2014  Logan Romantic
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+#ifndef COMPILER_STREAM_SCANNER_H_
+#define COMPILER_STREAM_SCANNER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <vector>
+#include "scanner.h"
+
+namespace llc
+{
+    // Scans a stream through a fixed-size window instead of loading it whole.
+    // A token is only handed out once the byte after it is in the window;
+    // otherwise the unfinished tail is moved to the front, the window is
+    // refilled and the token is scanned again. A single token longer than
+    // the window grows it, so memory is bounded by the larger of the window
+    // and the longest token.
+    //
+    // Token offsets are absolute stream offsets, so a stream may not exceed
+    // 4 GiB. Token values point into the window and are only valid until the
+    // next Scan().
+    class StreamScanner
+    {
+    public:
+        static const std::size_t kDefaultWindow = 1 << 20;
+
+        StreamScanner(std::istream& in, std::size_t window = kDefaultWindow);
+
+        Token Scan();
+
+        // Offsets must not decrease from one call to the next.
+        Coord Locate(std::uint32_t offset);
+
+        bool has_errors() const { return has_errors_; }
+        void set_max_diagnostics(std::size_t max) { max_diagnostics_ = max; }
+        void set_engine(ScanEngine engine) { scanner_.set_engine(engine); }
+        const Diagnostics& diagnostics() const { return diagnostics_; }
+        const std::vector<Coord>& diagnostic_coords() const { return diagnostic_coords_; }
+        const errors_vector& errors() const { return errors_; }
+        std::size_t window() const { return window_.size(); }
+        const Interner& interner() const { return scanner_.interner(); }
+
+    private:
+        void Refill(std::size_t keep);
+
+        std::istream& in_;
+        std::vector<char> window_;
+        std::size_t end_;
+        std::uint32_t base_;
+        bool eof_;
+        bool has_errors_;
+        std::size_t max_diagnostics_;
+        Scanner scanner_;
+
+        std::uint32_t located_;
+        int line_;
+        std::uint32_t line_start_;
+
+        Diagnostics diagnostics_;
+        std::vector<Coord> diagnostic_coords_;
+        errors_vector errors_;
+    };
+}
+
+#endif
@@ -17,12 +17,22 @@
 #ifndef COMPILER_TOKENS_H_
 #define COMPILER_TOKENS_H_
 
+#include <cstddef>
 #include <cstdint>
+#include <string>
+#include <string_view>
 
 namespace llc
 {
     enum class TokenType : std::int8_t;
 
+    // Value of an Integer (integer) or Float (real) literal.
+    union LiteralValue
+    {
+        std::uint64_t integer;
+        double real;
+    };
+
     struct Coord 
     {
         Coord() : line(-1), column(-1) {}
@@ -33,19 +43,29 @@ namespace llc
         int column;
     };
 
+    // value is a view into the scanner's input and is only valid while
+    // that input stays attached. Use Materialize() to keep it longer.
+    // offset is where the token starts; Scanner::Locate turns it into a
+    // line and column. Integer and Float tokens carry their value in literal,
+    // computed while scanning; Identifier and String tokens carry the
+    // scanner's Interner ID of their value in symbol.
     class Token
     {
     public:
         Token();
-        Token(TokenType token_type, std::string value, Coord coord);
+        Token(TokenType token_type, std::string_view value, std::uint32_t offset);
         ~Token();
 
-        static TokenType LookupIdentifier(const std::string& value);
-        std::string GetName() const;
+        static TokenType LookupIdentifier(std::string_view value);
+        static std::string_view Name(TokenType type);
+        std::string_view GetName() const;
+        std::string Materialize() const;
 
         TokenType type;
-        std::string value;
-        Coord coord;
+        std::string_view value;
+        std::uint32_t offset;
+        std::uint32_t symbol;
+        LiteralValue literal;
     };
 
     enum class TokenType : std::int8_t 
@@ -106,6 +126,41 @@ namespace llc
         FalseKey,
     };
 
+    constexpr std::size_t kTokenTypeCount = static_cast<std::size_t>(TokenType::FalseKey) + 1;
+
+    //Bytes between a token's start and its value: the opening quote of a string
+    inline std::uint32_t ValueSkip(TokenType type)
+    {
+        return type == TokenType::String ? 1 : 0;
+    }
+
+    // 12-byte form of a token for long-lived storage. The value is not kept;
+    // it is length bytes of the source at value_offset(). aux is 24 bits of
+    // per-type data: for Integer and Float tokens the index of the value in
+    // a LiteralTable, for Identifier and String tokens the symbol ID from an
+    // Interner. kNoAux means it did not fit; use the source text instead.
+    struct PackedToken
+    {
+        static constexpr std::uint32_t kNoAux = (1u << 24) - 1;
+
+        PackedToken() : offset(0), length(0), bits(0) {}
+        PackedToken(TokenType type, std::uint32_t offset_, std::uint32_t length_, std::uint32_t aux = 0)
+            : offset(offset_), length(length_),
+              bits(static_cast<std::uint8_t>(type) | (aux << 8))
+        {}
+
+        TokenType type() const { return static_cast<TokenType>(bits & 0xFF); }
+        std::uint32_t aux() const { return bits >> 8; }
+        std::uint32_t value_offset() const { return offset + ValueSkip(type()); }
+        std::string_view Value(const char* input) const { return std::string_view(input + value_offset(), length); }
+
+        std::uint32_t offset;
+        std::uint32_t length;
+        std::uint32_t bits;
+    };
+
+    static_assert(sizeof(PackedToken) == 12, "PackedToken must stay 12 bytes");
+
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,58 @@
+// llc is a compiler for a toy language
+// Copyright (C) 2014  Logan Romantic
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+#ifndef COMPILER_TOKEN_CACHE_H_
+#define COMPILER_TOKEN_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "diagnostics.h"
+#include "interner.h"
+#include "token_stream.h"
+
+namespace llc
+{
+    // Directory of scanned token streams keyed by a hash of the source
+    // bytes, one file per distinct content. A file holds the token columns,
+    // literal values, diagnostics and symbol names; loading it maps the file
+    // and copies the columns back instead of scanning.
+    //
+    // Files record the cache format, Scanner::kVersion and a fingerprint of
+    // the TokenType enum, and are ignored when any of them differs. Files
+    // are written under a temporary name and renamed into place, so runs
+    // sharing a directory never see a partial file. Cache failures are not
+    // errors; the caller simply scans.
+    class TokenCache
+    {
+    public:
+        static const std::uint32_t kFormatVersion = 1;
+
+        TokenCache(std::string directory);
+
+        bool Load(const char* data, std::size_t size, TokenStream& tokens,
+            Diagnostics& diagnostics, Interner& interner) const;
+        bool Store(const char* data, std::size_t size, const TokenStream& tokens,
+            const Diagnostics& diagnostics, const Interner& interner) const;
+
+    private:
+        std::string PathFor(std::uint64_t hash) const;
+
+        std::string directory_;
+    };
+}
+
+#endif
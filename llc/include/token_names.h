@@ -0,0 +1,101 @@
+// llc is a compiler for a toy language
+// Copyright (C) 2014  Logan Romantic
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+#ifndef COMPILER_TOKEN_NAMES_H_
+#define COMPILER_TOKEN_NAMES_H_
+
+#include <cstddef>
+#include <string_view>
+#include "token.h"
+
+namespace llc
+{
+    // Printable name of every TokenType. For symbols the name is also the
+    // spelling, which the table-driven scanner builds its automaton from.
+    struct TokenName
+    {
+        TokenType type;
+        std::string_view name;
+    };
+
+    //Indexed by TokenType
+    inline constexpr TokenName token_names[] = {
+        { TokenType::Illegal, "ILLEGAL" },
+        { TokenType::Eof, "EOF" },
+        { TokenType::Comment, "COMMENT" },
+        { TokenType::Identifier, "IDENT" },
+        { TokenType::Integer, "INT" },
+        { TokenType::Float, "FLOAT" },
+        { TokenType::Bool, "BOOL" },
+        { TokenType::String, "STRING" },
+        { TokenType::SemiColon, ";" },
+        { TokenType::Comma, "," },
+        { TokenType::Lparen, "(" },
+        { TokenType::Rparen, ")" },
+        { TokenType::Lbracket, "[" },
+        { TokenType::Rbracket, "]" },
+        { TokenType::Assign, ":=" },
+        { TokenType::Or, "|" },
+        { TokenType::And, "&" },
+        { TokenType::Add, "+" },
+        { TokenType::Sub, "-" },
+        { TokenType::Mul, "*" },
+        { TokenType::Div, "/" },
+        { TokenType::Less, "<" },
+        { TokenType::Greater, ">" },
+        { TokenType::LessEql, "<=" },
+        { TokenType::GreaterEql, ">=" },
+        { TokenType::Eql, "==" },
+        { TokenType::Neq, "!=" },
+        { TokenType::Program, "program" },
+        { TokenType::Is, "is" },
+        { TokenType::Begin, "begin" },
+        { TokenType::End, "end" },
+        { TokenType::Global, "global" },
+        { TokenType::Procedure, "procedure" },
+        { TokenType::In, "in" },
+        { TokenType::Out, "out" },
+        { TokenType::IntegerType, "integer" },
+        { TokenType::FloatType, "float" },
+        { TokenType::BoolType, "bool" },
+        { TokenType::StringType, "string" },
+        { TokenType::If, "if" },
+        { TokenType::Then, "then" },
+        { TokenType::Else, "else" },
+        { TokenType::For, "for" },
+        { TokenType::Return, "return" },
+        { TokenType::Not, "not" },
+        { TokenType::TrueKey, "true" },
+        { TokenType::FalseKey, "false" },
+    };
+
+    constexpr bool hTokenNamesInOrder()
+    {
+        for (std::size_t i = 0; i < kTokenTypeCount; ++i)
+        {
+            if (static_cast<std::size_t>(token_names[i].type) != i)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static_assert(sizeof(token_names) / sizeof(token_names[0]) == kTokenTypeCount, "every TokenType needs a name");
+    static_assert(hTokenNamesInOrder(), "token_names must follow the TokenType order");
+}
+
+#endif
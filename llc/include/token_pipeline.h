@@ -0,0 +1,72 @@
+// llc is a compiler for a toy language
+// Copyright (C) 2014  Logan Romantic
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+#ifndef COMPILER_TOKEN_PIPELINE_H_
+#define COMPILER_TOKEN_PIPELINE_H_
+
+#include <cstddef>
+#include <thread>
+#include "scanner.h"
+#include "spsc_queue.h"
+#include "token.h"
+
+namespace llc
+{
+    // Runs a scanner on its own thread, one batch of tokens ahead of the
+    // consumer. Batches travel through a bounded SpscQueue; when it is full
+    // the scanner waits, so memory use does not depend on the input size.
+    //
+    // Without comments the scanner skips them instead of passing them on.
+    // The scanner belongs to the pipeline until Finish(), which drains the
+    // remaining tokens and joins the thread; its diagnostics are complete
+    // and safe to read only after that. The destructor calls Finish().
+    class TokenPipeline
+    {
+    public:
+        static const std::size_t kBatchTokens = 512;
+        static const std::size_t kBatches = 32;
+
+        explicit TokenPipeline(Scanner& scanner, bool comments = true);
+        ~TokenPipeline();
+
+        TokenPipeline(const TokenPipeline&) = delete;
+        TokenPipeline& operator=(const TokenPipeline&) = delete;
+
+        //Like Scanner::Scan: returns Eof again once the input is exhausted
+        Token Next();
+        void Finish();
+
+    private:
+        struct Batch
+        {
+            std::size_t count;
+            Token tokens[kBatchTokens];
+        };
+
+        template <typename Policy>
+        void Produce();
+
+        Scanner& scanner_;
+        SpscQueue<Batch> queue_;
+        Batch* current_;
+        std::size_t index_;
+        bool done_;
+        Token eof_;
+        std::thread producer_;
+    };
+}
+
+#endif
@@ -0,0 +1,89 @@
+// llc is a compiler for a toy language
+// Copyright (C) 2014  Logan Romantic
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+#ifndef COMPILER_TOKEN_STREAM_H_
+#define COMPILER_TOKEN_STREAM_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "interner.h"
+#include "literals.h"
+#include "token.h"
+
+namespace llc
+{
+    // Struct-of-arrays token stream produced by Scanner::ScanAll. offset(i)
+    // is where token i starts (Token::offset) and value(i) is the same
+    // bytes as Token::value, which skips the opening quote of a string.
+    // The stream always ends with an Eof token.
+    //
+    // A fourth column holds each token's aux: Integer and Float values are
+    // kept in literals(), Identifier and String tokens hold the symbol ID
+    // from the interner of the scanner that produced them.
+    class TokenStream
+    {
+    public:
+        TokenStream();
+        TokenStream(const char* input);
+
+        void Reserve(std::size_t count);
+        void Resize(std::size_t count);
+        void Clear();
+        void Push(const Token& token);
+        void ResizeLiterals(std::size_t count) { literals_.Resize(count); }
+        void CopyFrom(const TokenStream& other, std::size_t first, std::size_t count, std::size_t at,
+            std::uint32_t literal_at, const std::vector<std::uint32_t>& symbol_map);
+        void Splice(std::size_t first, std::size_t last, const TokenStream& replacement, std::size_t count, std::int64_t shift);
+        void set_input(const char* input) { input_ = input; }
+
+        std::size_t size() const { return types_.size(); }
+        TokenType type(std::size_t i) const { return types_[i]; }
+        std::uint32_t offset(std::size_t i) const { return offsets_[i]; }
+        std::uint32_t length(std::size_t i) const { return lengths_[i]; }
+        std::uint32_t aux(std::size_t i) const { return aux_[i]; }
+        std::uint32_t value_offset(std::size_t i) const;
+        std::string_view value(std::size_t i) const;
+        Token token(std::size_t i) const;
+        PackedToken packed(std::size_t i) const;
+        bool Literal(std::size_t i, LiteralValue& value) const;
+
+        // Literal table entries, and symbol IDs, used by tokens before i.
+        std::uint32_t LiteralsBefore(std::size_t i) const;
+        std::uint32_t SymbolsBefore(std::size_t i) const;
+
+        const std::vector<TokenType>& types() const { return types_; }
+        const std::vector<std::uint32_t>& offsets() const { return offsets_; }
+        const std::vector<std::uint32_t>& lengths() const { return lengths_; }
+        const LiteralTable& literals() const { return literals_; }
+
+    private:
+        friend class TokenCache;
+
+        void CompactLiterals();
+
+        const char* input_;
+        std::vector<TokenType> types_;
+        std::vector<std::uint32_t> offsets_;
+        std::vector<std::uint32_t> lengths_;
+        std::vector<std::uint32_t> aux_;
+        LiteralTable literals_;
+        std::size_t dead_literals_;
+    };
+}
+
+#endif
@@ -0,0 +1,122 @@
+// llc is a compiler for a toy language
+// Copyright (C) 2014  Logan Romantic
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+// Compares Token::LookupIdentifier against the std::map lookup it replaced
+// on an identifier-heavy word list (roughly one keyword per three words).
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+#include "token.h"
+
+using llc::Token;
+using llc::TokenType;
+
+std::map<std::string, TokenType> keywords = {
+    {"program", TokenType::Program},
+    {"is", TokenType::Is},
+    {"begin", TokenType::Begin},
+    {"end", TokenType::End},
+    {"global", TokenType::Global},
+    {"procedure", TokenType::Procedure},
+    {"in", TokenType::In},
+    {"out", TokenType::Out},
+    {"integer", TokenType::IntegerType},
+    {"float", TokenType::FloatType},
+    {"bool", TokenType::BoolType},
+    {"string", TokenType::StringType},
+    {"if", TokenType::If},
+    {"then", TokenType::Then},
+    {"else", TokenType::Else},
+    {"for", TokenType::For},
+    {"return", TokenType::Return},
+    {"not", TokenType::Not},
+    {"true", TokenType::TrueKey},
+    {"false", TokenType::FalseKey},
+};
+
+TokenType MapLookup(const std::string& value)
+{
+    if (keywords.find(value) != keywords.end()) {
+        return keywords[value];
+    }
+    return TokenType::Identifier;
+}
+
+std::vector<std::string> MakeWords(std::size_t count)
+{
+    std::vector<std::string> pool;
+    for (const auto& kw : keywords)
+    {
+        pool.push_back(kw.first);
+    }
+
+    std::mt19937 rng(42);
+    const char alphabet[] = "abcdefghijklmnopqrstuvwxyz_0123456789";
+    std::vector<std::string> words;
+    words.reserve(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        if (rng() % 3 == 0)
+        {
+            words.push_back(pool[rng() % pool.size()]);
+            continue;
+        }
+        std::string word(1, alphabet[rng() % 26]);
+        std::size_t length = 1 + rng() % 10;
+        for (std::size_t j = 1; j < length; ++j)
+        {
+            word.push_back(alphabet[rng() % (sizeof(alphabet) - 1)]);
+        }
+        words.push_back(word);
+    }
+    return words;
+}
+
+template <typename F>
+double Measure(const char* name, const std::vector<std::string>& words, int rounds, F lookup)
+{
+    unsigned long hits = 0;
+    auto begin = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r)
+    {
+        for (const auto& word : words)
+        {
+            hits += lookup(word) != TokenType::Identifier;
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double ns = std::chrono::duration<double, std::nano>(end - begin).count();
+    double per_lookup = ns / (static_cast<double>(words.size()) * rounds);
+    std::printf("%-16s %8.2f ns/lookup  (%lu keyword hits)\n", name, per_lookup, hits);
+    return per_lookup;
+}
+
+int main()
+{
+    const int rounds = 20;
+    std::vector<std::string> words = MakeWords(1 << 20);
+
+    double before = Measure("std::map", words, rounds, MapLookup);
+    double after = Measure("perfect hash", words, rounds,
+        [](const std::string& w) { return Token::LookupIdentifier(w); });
+
+    std::printf("speedup          %8.2fx\n", before / after);
+}
@@ -0,0 +1,77 @@
+// llc is a compiler for a toy language
+// Copyright (C) 2014  Logan Romantic
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include "arena.h"
+
+namespace llc
+{
+    Arena::Arena(std::size_t block_size)
+        : block_size_(block_size), first_block_size_(0), next_(nullptr), end_(nullptr), allocated_(0)
+    {}
+
+    void* Arena::Allocate(std::size_t size, std::size_t align)
+    {
+        std::uintptr_t p = (reinterpret_cast<std::uintptr_t>(next_) + align - 1) & ~(align - 1);
+        if (next_ == nullptr || p + size > reinterpret_cast<std::uintptr_t>(end_))
+        {
+            //Oversized requests get a block of their own
+            std::size_t block = std::max(block_size_, size + align);
+            blocks_.emplace_back(new char[block]);
+            if (blocks_.size() == 1)
+            {
+                first_block_size_ = block;
+            }
+            next_ = blocks_.back().get();
+            end_ = next_ + block;
+            allocated_ += block;
+            p = (reinterpret_cast<std::uintptr_t>(next_) + align - 1) & ~(align - 1);
+        }
+
+        next_ = reinterpret_cast<char*>(p + size);
+        return reinterpret_cast<void*>(p);
+    }
+
+    std::string_view Arena::Copy(std::string_view bytes)
+    {
+        char* data = static_cast<char*>(Allocate(bytes.size(), 1));
+        std::memcpy(data, bytes.data(), bytes.size());
+        return std::string_view(data, bytes.size());
+    }
+
+    void Arena::Clear()
+    {
+        blocks_.clear();
+        next_ = nullptr;
+        end_ = nullptr;
+        allocated_ = 0;
+    }
+
+    void Arena::Reset()
+    {
+        if (blocks_.empty())
+        {
+            return;
+        }
+
+        blocks_.resize(1);
+        next_ = blocks_.front().get();
+        end_ = next_ + first_block_size_;
+        allocated_ = first_block_size_;
+    }
+}
@@ -0,0 +1,122 @@
+// llc is a compiler for a toy language
+// Copyright (C) 2014  Logan Romantic
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+#include <algorithm>
+#include "diagnostics.h"
+#include "token.h"
+
+namespace llc
+{
+    Diagnostics::Diagnostics()
+        : counts_()
+    {}
+
+    void Diagnostics::Report(DiagCode code, std::uint32_t offset, char arg)
+    {
+        records_.push_back({ offset, code, arg });
+        counts_[static_cast<int>(SeverityOf(code))] += 1;
+    }
+
+    void Diagnostics::Append(Span<const Diagnostic> records, std::int64_t shift)
+    {
+        for (const Diagnostic& d : records)
+        {
+            Report(d.code, static_cast<std::uint32_t>(d.offset + shift), d.arg);
+        }
+    }
+
+    void Diagnostics::Truncate(std::size_t count)
+    {
+        for (std::size_t i = count; i < records_.size(); ++i)
+        {
+            counts_[static_cast<int>(SeverityOf(records_[i].code))] -= 1;
+        }
+        records_.resize(std::min(count, records_.size()));
+    }
+
+    void Diagnostics::Clear()
+    {
+        records_.clear();
+        counts_[0] = counts_[1] = 0;
+    }
+
+    std::size_t Diagnostics::LowerBound(std::uint32_t offset) const
+    {
+        auto it = std::lower_bound(records_.begin(), records_.end(), offset,
+            [](const Diagnostic& d, std::uint32_t value) { return d.offset < value; });
+        return static_cast<std::size_t>(it - records_.begin());
+    }
+
+    Severity Diagnostics::SeverityOf(DiagCode code)
+    {
+        switch (code)
+        {
+        case DiagCode::UnexpectedChar:
+            return Severity::Warning;
+        case DiagCode::CharNotAllowed:
+        case DiagCode::UnterminatedString:
+        case DiagCode::NumberOutOfRange:
+        case DiagCode::TooManyDiagnostics:
+        case DiagCode::ExpectedToken:
+        case DiagCode::UnexpectedToken:
+            return Severity::Error;
+        }
+        return Severity::Error;
+    }
+
+    void Diagnostics::Format(const Diagnostic& diagnostic, std::string& out)
+    {
+        switch (diagnostic.code)
+        {
+        case DiagCode::UnexpectedChar:
+            out += "Unexpected value '";
+            out += diagnostic.arg;
+            out += "'";
+            break;
+        case DiagCode::CharNotAllowed:
+            out += "Character '";
+            out += diagnostic.arg;
+            out += "' is not allowed in string";
+            break;
+        case DiagCode::UnterminatedString:
+            out += "Unterminated string";
+            break;
+        case DiagCode::NumberOutOfRange:
+            out += "Number is out of range";
+            break;
+        case DiagCode::TooManyDiagnostics:
+            out += "Too many diagnostics, scanning stopped";
+            break;
+        case DiagCode::ExpectedToken:
+            out += "Expected '";
+            out += Token::Name(static_cast<TokenType>(diagnostic.arg));
+            out += "'";
+            break;
+        case DiagCode::UnexpectedToken:
+            out += "Unexpected token '";
+            out += Token::Name(static_cast<TokenType>(diagnostic.arg));
+            out += "'";
+            break;
+        }
+    }
+
+    std::string Diagnostics::Message(const Diagnostic& diagnostic)
+    {
+        std::string message;
+        Format(diagnostic, message);
+        return message;
+    }
+}
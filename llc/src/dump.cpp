@@ -0,0 +1,168 @@
+// llc is a compiler for a toy language
+// Copyright (C) 2014  Logan Romantic
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+#include <charconv>
+#include "dump.h"
+
+namespace llc
+{
+    const std::size_t kFlushThreshold = 1 << 20;
+
+    TokenDumper::TokenDumper(DumpFormat format, std::FILE* sink)
+        : format_(format), sink_(sink)
+    {
+        buffer_.reserve(kFlushThreshold + 4096);
+    }
+
+    TokenDumper::~TokenDumper()
+    {
+        Flush();
+    }
+
+    void TokenDumper::BeginFile(std::string_view path)
+    {
+        if (format_ == DumpFormat::Text)
+        {
+            Put("Scanning ");
+            Put(path);
+            Put("\n");
+            return;
+        }
+
+        Put("LLCT");
+        PutU8(kBinaryVersion);
+        PutU32(static_cast<std::uint32_t>(path.size()));
+        Put(path);
+    }
+
+    void TokenDumper::DumpTokens(const TokenStream& tokens)
+    {
+        std::size_t count = tokens.size() - 1;
+
+        if (format_ == DumpFormat::Text)
+        {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                DumpToken(tokens.token(i));
+            }
+            return;
+        }
+
+        PutU32(static_cast<std::uint32_t>(count));
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            PutU8(static_cast<std::uint8_t>(tokens.type(i)));
+            PutU32(tokens.value_offset(i));
+            PutU32(tokens.length(i));
+            MaybeFlush();
+        }
+    }
+
+    void TokenDumper::DumpDiagnostics(const Scanner& scanner)
+    {
+        Span<const Diagnostic> records = scanner.diagnostics().records();
+
+        if (format_ == DumpFormat::Text)
+        {
+            for (const Diagnostic& d : records)
+            {
+                DumpDiagnostic(d, scanner.Locate(d.offset));
+            }
+            return;
+        }
+
+        PutU32(static_cast<std::uint32_t>(records.size()));
+        for (const Diagnostic& d : records)
+        {
+            Coord coord = scanner.Locate(d.offset);
+            message_.clear();
+            Diagnostics::Format(d, message_);
+
+            PutU32(d.offset);
+            PutU32(static_cast<std::uint32_t>(coord.line));
+            PutU32(static_cast<std::uint32_t>(coord.column));
+            PutU32(static_cast<std::uint32_t>(message_.size()));
+            Put(message_);
+            MaybeFlush();
+        }
+    }
+
+    //The reason goes to stderr; binary output must still be well-formed
+    void TokenDumper::DumpUnreadable()
+    {
+        if (format_ == DumpFormat::Binary)
+        {
+            PutU32(0);
+            PutU32(0);
+        }
+    }
+
+    void TokenDumper::DumpToken(const Token& token)
+    {
+        Put(Token::Name(token.type));
+        PutU8(' ');
+        Put(token.value);
+        PutU8('\n');
+        MaybeFlush();
+    }
+
+    void TokenDumper::DumpDiagnostic(const Diagnostic& diagnostic, Coord coord)
+    {
+        Diagnostics::Format(diagnostic, buffer_);
+        Put(" (line ");
+        PutInt(coord.line);
+        Put(", column ");
+        PutInt(coord.column);
+        Put(")\n");
+        MaybeFlush();
+    }
+
+    void TokenDumper::Flush()
+    {
+        if (sink_ != nullptr && !buffer_.empty())
+        {
+            std::fwrite(buffer_.data(), 1, buffer_.size(), sink_);
+            std::fflush(sink_);
+            buffer_.clear();
+        }
+    }
+
+    void TokenDumper::PutU32(std::uint32_t value)
+    {
+        char bytes[4] = {
+            static_cast<char>(value),
+            static_cast<char>(value >> 8),
+            static_cast<char>(value >> 16),
+            static_cast<char>(value >> 24),
+        };
+        buffer_.append(bytes, 4);
+    }
+
+    void TokenDumper::PutInt(int value)
+    {
+        char digits[16];
+        auto result = std::to_chars(digits, digits + sizeof(digits), value);
+        buffer_.append(digits, result.ptr);
+    }
+
+    void TokenDumper::MaybeFlush()
+    {
+        if (sink_ != nullptr && buffer_.size() >= kFlushThreshold)
+        {
+            Flush();
+        }
+    }
+}
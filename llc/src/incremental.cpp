@@ -0,0 +1,130 @@
+// llc is a compiler for a toy language
+// Copyright (C) 2014  Logan Romantic
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+#include <algorithm>
+#include "incremental.h"
+
+namespace llc
+{
+    IncrementalLexer::IncrementalLexer()
+        : relexed_(0)
+    {
+        Reset("");
+    }
+
+    void IncrementalLexer::Reset(std::string text)
+    {
+        text_ = std::move(text);
+        lines_.Clear();
+        interner_.Clear();
+
+        Scanner scanner;
+        scanner.set_interner(&interner_);
+        scanner.AttachBuffer(text_.data(), text_.size());
+        tokens_ = scanner.ScanAll();
+        diagnostics_ = scanner.diagnostics();
+        relexed_ = tokens_.size();
+    }
+
+    bool IncrementalLexer::Apply(const TextEdit& edit)
+    {
+        if (edit.offset > text_.size() || edit.removed > text_.size() - edit.offset)
+        {
+            return false;
+        }
+
+        const std::vector<std::uint32_t>& offsets = tokens_.offsets();
+        std::int64_t shift = static_cast<std::int64_t>(edit.inserted.size()) - edit.removed;
+        std::uint32_t edit_end = static_cast<std::uint32_t>(edit.offset + edit.inserted.size());
+
+        //A token looks at its own bytes and at most the one after it, so
+        //tokens before the last one starting ahead of the edit are unaffected
+        std::size_t first = static_cast<std::size_t>(
+            std::lower_bound(offsets.begin(), offsets.end(), edit.offset) - offsets.begin());
+        std::uint32_t restart = 0;
+        if (first > 0)
+        {
+            first -= 1;
+            restart = offsets[first];
+        }
+
+        text_.replace(edit.offset, edit.removed, edit.inserted);
+        tokens_.set_input(text_.data());
+        lines_.Clear();
+
+        //Symbol IDs stay stable across edits; names of removed tokens are kept
+        Scanner scanner;
+        scanner.set_interner(&interner_);
+        scanner.AttachBuffer(text_.data(), text_.size(), restart);
+
+        TokenStream relexed(text_.data());
+        std::size_t last = offsets.size();
+        for (;;)
+        {
+            Token token = scanner.Scan();
+            if (token.offset >= edit_end && token.type != TokenType::Eof)
+            {
+                //Same text from here on: resync if an old token started here
+                std::uint32_t old_offset = static_cast<std::uint32_t>(token.offset - shift);
+                auto it = std::lower_bound(offsets.begin() + first, offsets.end(), old_offset);
+                if (it != offsets.end() && *it == old_offset)
+                {
+                    last = static_cast<std::size_t>(it - offsets.begin());
+                    break;
+                }
+            }
+
+            relexed.Push(token);
+            if (token.type == TokenType::Eof)
+            {
+                break;
+            }
+        }
+        relexed_ = relexed.size();
+
+        //Diagnostics carry the offset of the token that raised them. The
+        //scanner already reported the resync token, whose old ones are reused.
+        std::uint32_t reused = last < offsets.size() ? offsets[last] : static_cast<std::uint32_t>(-1);
+        std::int64_t reused_now = last < offsets.size() ? reused + shift : reused;
+        Span<const Diagnostic> old_records = diagnostics_.records();
+        Span<const Diagnostic> new_records = scanner.diagnostics().records();
+        std::size_t kept = diagnostics_.LowerBound(restart);
+        std::size_t fresh = 0;
+        while (fresh < new_records.size() && new_records[fresh].offset < reused_now)
+        {
+            fresh += 1;
+        }
+        std::size_t moved = diagnostics_.LowerBound(reused);
+
+        Diagnostics diagnostics;
+        diagnostics.Append(Span<const Diagnostic>(old_records.data(), kept));
+        diagnostics.Append(Span<const Diagnostic>(new_records.data(), fresh));
+        diagnostics.Append(Span<const Diagnostic>(old_records.data() + moved, old_records.size() - moved), shift);
+        diagnostics_ = std::move(diagnostics);
+
+        tokens_.Splice(first, last, relexed, relexed.size(), shift);
+        return true;
+    }
+
+    Coord IncrementalLexer::Locate(std::uint32_t offset) const
+    {
+        if (!lines_.built())
+        {
+            lines_.Build(text_.data(), text_.size());
+        }
+        return lines_.Locate(offset);
+    }
+}
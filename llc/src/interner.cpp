@@ -0,0 +1,120 @@
+// llc is a compiler for a toy language
+// Copyright (C) 2014  Logan Romantic
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+#include <algorithm>
+#include "interner.h"
+
+namespace llc
+{
+    const std::size_t kInitialSlots = 1024;
+
+    //FNV-1a, short identifiers dominate
+    std::uint32_t hHashName(std::string_view name)
+    {
+        std::uint32_t hash = 2166136261u;
+        for (char c : name)
+        {
+            hash = (hash ^ static_cast<unsigned char>(c)) * 16777619u;
+        }
+        return hash;
+    }
+
+    Interner::Interner()
+        : slots_(kInitialSlots, kNoSymbol)
+    {}
+
+    std::uint32_t Interner::Intern(std::string_view name)
+    {
+        //Keep the load factor at or below one half
+        if ((entries_.size() + 1) * 2 > slots_.size())
+        {
+            Grow();
+        }
+
+        std::uint32_t hash = hHashName(name);
+        std::size_t mask = slots_.size() - 1;
+        for (std::size_t i = hash & mask;; i = (i + 1) & mask)
+        {
+            std::uint32_t symbol = slots_[i];
+            if (symbol == kNoSymbol)
+            {
+                symbol = static_cast<std::uint32_t>(entries_.size());
+                entries_.push_back({ names_.Copy(name), hash });
+                slots_[i] = symbol;
+                return symbol;
+            }
+            if (entries_[symbol].hash == hash && entries_[symbol].name == name)
+            {
+                return symbol;
+            }
+        }
+    }
+
+    std::uint32_t Interner::Find(std::string_view name) const
+    {
+        std::uint32_t hash = hHashName(name);
+        std::size_t mask = slots_.size() - 1;
+        for (std::size_t i = hash & mask;; i = (i + 1) & mask)
+        {
+            std::uint32_t symbol = slots_[i];
+            if (symbol == kNoSymbol || (entries_[symbol].hash == hash && entries_[symbol].name == name))
+            {
+                return symbol;
+            }
+        }
+    }
+
+    void Interner::Truncate(std::size_t count)
+    {
+        //Newest first: each one is then the last entry on its probe chain,
+        //so emptying its slot leaves the table as it was before the insert
+        std::size_t mask = slots_.size() - 1;
+        while (entries_.size() > count)
+        {
+            std::uint32_t symbol = static_cast<std::uint32_t>(entries_.size() - 1);
+            std::size_t i = entries_.back().hash & mask;
+            while (slots_[i] != symbol)
+            {
+                i = (i + 1) & mask;
+            }
+            slots_[i] = kNoSymbol;
+            entries_.pop_back();
+        }
+    }
+
+    void Interner::Clear()
+    {
+        names_.Reset();
+        entries_.clear();
+        std::fill(slots_.begin(), slots_.end(), kNoSymbol);
+    }
+
+    void Interner::Grow()
+    {
+        std::vector<std::uint32_t> slots(slots_.size() * 2, kNoSymbol);
+        std::size_t mask = slots.size() - 1;
+        for (std::uint32_t symbol = 0; symbol < entries_.size(); ++symbol)
+        {
+            std::size_t i = entries_[symbol].hash & mask;
+            while (slots[i] != kNoSymbol)
+            {
+                i = (i + 1) & mask;
+            }
+            slots[i] = symbol;
+        }
+        slots_.swap(slots);
+    }
+}
@@ -0,0 +1,57 @@
+// llc is a compiler for a toy language
+// Copyright (C) 2014  Logan Romantic
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+#include <algorithm>
+#include "line_index.h"
+#include "simd.h"
+
+namespace llc
+{
+    LineIndex::LineIndex()
+        : built_(false)
+    {}
+
+    void LineIndex::Build(const char* data, std::size_t size)
+    {
+        starts_.clear();
+        starts_.push_back(0);
+
+        const char* end = data + size;
+        for (const char* nl = FindNewline(data, end); nl != end; nl = FindNewline(nl + 1, end))
+        {
+            starts_.push_back(static_cast<std::uint32_t>(nl + 1 - data));
+        }
+        built_ = true;
+    }
+
+    void LineIndex::Clear()
+    {
+        starts_.clear();
+        built_ = false;
+    }
+
+    Coord LineIndex::Locate(std::uint32_t offset) const
+    {
+        if (starts_.empty())
+        {
+            return Coord();
+        }
+
+        auto next = std::upper_bound(starts_.begin(), starts_.end(), offset);
+        std::size_t line = static_cast<std::size_t>(next - starts_.begin());
+        return Coord(static_cast<int>(line), static_cast<int>(offset - *(next - 1)) + 1);
+    }
+}
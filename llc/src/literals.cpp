@@ -0,0 +1,92 @@
+// llc is a compiler for a toy language
+// Copyright (C) 2014  Logan Romantic
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+#include <algorithm>
+#include <charconv>
+#include <limits>
+#include <string>
+#include "literals.h"
+
+namespace llc
+{
+    const std::size_t kFloatBuffer = 64;
+
+    std::uint32_t LiteralTable::Add(LiteralValue value)
+    {
+        if (values_.size() >= PackedToken::kNoAux)
+        {
+            return PackedToken::kNoAux;
+        }
+        values_.push_back(value);
+        return static_cast<std::uint32_t>(values_.size() - 1);
+    }
+
+    void LiteralTable::Resize(std::size_t count)
+    {
+        values_.resize(std::min<std::size_t>(count, PackedToken::kNoAux));
+    }
+
+    bool hDecodeInteger(std::string_view text, std::uint64_t& value)
+    {
+        const std::uint64_t max = std::numeric_limits<std::uint64_t>::max();
+
+        value = 0;
+        for (char c : text)
+        {
+            if (c == '_')
+            {
+                continue;
+            }
+            std::uint64_t digit = static_cast<std::uint64_t>(c - '0');
+            if (value > (max - digit) / 10)
+            {
+                return false;
+            }
+            value = value * 10 + digit;
+        }
+        return true;
+    }
+
+    bool hDecodeFloat(std::string_view text, double& value)
+    {
+        //from_chars does not know separators, drop them first
+        char small[kFloatBuffer];
+        std::string large;
+        char* digits = small;
+        if (text.size() > kFloatBuffer)
+        {
+            large.resize(text.size());
+            digits = &large[0];
+        }
+
+        char* end = std::remove_copy(text.begin(), text.end(), digits, '_');
+        auto result = std::from_chars(digits, end, value);
+        return result.ec == std::errc() && result.ptr == end;
+    }
+
+    bool DecodeLiteral(TokenType type, std::string_view text, LiteralValue& value)
+    {
+        if (type == TokenType::Integer)
+        {
+            return hDecodeInteger(text, value.integer);
+        }
+        if (type == TokenType::Float)
+        {
+            return hDecodeFloat(text, value.real);
+        }
+        return false;
+    }
+}
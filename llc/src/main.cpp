@@ -14,32 +14,423 @@
 // You should have received a copy of the GNU General Public License
 // along with this program; if not, write to the Free Software
 // Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
+#include "dump.h"
+#include "parser.h"
 #include "scanner.h"
+#include "stats.h"
+#include "stream_scanner.h"
+#include "token_cache.h"
+#include "token_pipeline.h"
+#include "parallel_for.h"
 
-std::string FormatCoord(const llc::Coord& coord);
+struct Options
+{
+    Options() : jobs(0), max_diagnostics(0), format(llc::DumpFormat::Text), engine(llc::ScanEngine::Handwritten), stream(false), parse(false), pipeline(false), stats(false) {}
+
+    unsigned jobs;
+    std::size_t max_diagnostics;
+    llc::DumpFormat format;
+    llc::ScanEngine engine;
+    bool stream;
+    bool parse;
+    bool pipeline;
+    bool stats;
+    std::string cache_dir;
+    std::vector<std::string> files;
+};
+
+struct FileResult
+{
+    FileResult() : failed(false), done(false) {}
+
+    std::string out;
+    std::string err;
+    bool failed;
+    bool done;
+};
+
+void PrintUsage()
+{
+    std::cerr << "Usage: compiler [-j jobs] [--dump=text|binary] [--engine=hand|dfa] [--stream] [--parse] [--pipeline] [--max-diagnostics=N] [--cache-dir=DIR] [--stats] file... | @response-file" << std::endl;
+}
+
+bool ReadResponseFile(const std::string& path, std::vector<std::string>& files)
+{
+    std::ifstream in(path);
+    if (!in.is_open())
+    {
+        std::cerr << "Cannot open response file '" << path << "'" << std::endl;
+        return false;
+    }
+
+    //One path per line, so paths may contain spaces
+    std::string file;
+    while (std::getline(in, file))
+    {
+        if (!file.empty() && file.back() == '\r')
+        {
+            file.pop_back();
+        }
+        if (!file.empty())
+        {
+            files.push_back(file);
+        }
+    }
+    return true;
+}
+
+bool ParseArgs(int argc, char* argv[], Options& options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "-j" || (arg.size() > 2 && arg.compare(0, 2, "-j") == 0))
+        {
+            std::string value = arg.size() > 2 ? arg.substr(2) : (i + 1 < argc ? argv[++i] : "");
+            char* end = nullptr;
+            long jobs = std::strtol(value.c_str(), &end, 10);
+            if (value.empty() || *end != '\0' || jobs < 1)
+            {
+                std::cerr << "Invalid job count '" << value << "'" << std::endl;
+                return false;
+            }
+            options.jobs = static_cast<unsigned>(jobs);
+        }
+        else if (arg == "--dump=text")
+        {
+            options.format = llc::DumpFormat::Text;
+        }
+        else if (arg == "--dump=binary")
+        {
+            options.format = llc::DumpFormat::Binary;
+        }
+        else if (arg == "--engine=hand")
+        {
+            options.engine = llc::ScanEngine::Handwritten;
+        }
+        else if (arg == "--engine=dfa")
+        {
+            options.engine = llc::ScanEngine::Dfa;
+        }
+        else if (arg.compare(0, 18, "--max-diagnostics=") == 0)
+        {
+            std::string value = arg.substr(18);
+            char* end = nullptr;
+            long max = std::strtol(value.c_str(), &end, 10);
+            if (value.empty() || *end != '\0' || max < 0)
+            {
+                std::cerr << "Invalid diagnostic limit '" << value << "'" << std::endl;
+                return false;
+            }
+            options.max_diagnostics = static_cast<std::size_t>(max);
+        }
+        else if (arg.compare(0, 12, "--cache-dir=") == 0 && arg.size() > 12)
+        {
+            options.cache_dir = arg.substr(12);
+        }
+        else if (arg == "--stream")
+        {
+            options.stream = true;
+        }
+        else if (arg == "--parse")
+        {
+            options.parse = true;
+        }
+        else if (arg == "--pipeline")
+        {
+            options.pipeline = true;
+        }
+        else if (arg == "--stats")
+        {
+            if (!llc::kStatsEnabled)
+            {
+                std::cerr << "--stats needs a build with statistics (make STATS=1)" << std::endl;
+                return false;
+            }
+            options.stats = true;
+        }
+        else if (arg.size() > 1 && arg[0] == '@')
+        {
+            if (!ReadResponseFile(arg.substr(1), options.files))
+            {
+                return false;
+            }
+        }
+        else
+        {
+            options.files.push_back(arg);
+        }
+    }
+
+    if (options.files.empty())
+    {
+        std::cerr << "Expecting input file" << std::endl;
+        return false;
+    }
+    if (options.stream && options.format != llc::DumpFormat::Text)
+    {
+        std::cerr << "--stream only supports --dump=text" << std::endl;
+        return false;
+    }
+    if (options.parse && (options.stream || options.format != llc::DumpFormat::Text || !options.cache_dir.empty()))
+    {
+        std::cerr << "--parse cannot be combined with --stream, --dump=binary or --cache-dir" << std::endl;
+        return false;
+    }
+    if (options.pipeline && (options.stream || options.format != llc::DumpFormat::Text || !options.cache_dir.empty()))
+    {
+        std::cerr << "--pipeline cannot be combined with --stream, --dump=binary or --cache-dir" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void ScanFile(const std::string& path, const Options& options, unsigned lex_workers,
+    llc::TokenDumper& dumper, FileResult& result)
+{
+    llc::Scanner ss;
+    {
+        LLC_STATS_TIME(llc::StatPhase::Read);
+        ss.AttachFile(path);
+    }
+    ss.set_max_diagnostics(options.max_diagnostics);
+    ss.set_engine(options.engine);
+    if (ss.has_errors())
+    {
+        for (const auto& x : ss.errors())
+        {
+            result.err += x->message() + "\n";
+        }
+        result.failed = true;
+        dumper.DumpUnreadable();
+    }
+    else if (options.pipeline)
+    {
+        //The scanner runs on its own thread; this one only waits and dumps
+        LLC_STATS_TIME(llc::StatPhase::Dump);
+        llc::TokenPipeline pipeline(ss);
+        for (llc::Token token = pipeline.Next(); token.type != llc::TokenType::Eof; token = pipeline.Next())
+        {
+            dumper.DumpToken(token);
+        }
+        pipeline.Finish();
+        dumper.DumpDiagnostics(ss);
+        result.failed = ss.has_errors();
+    }
+    else
+    {
+        llc::TokenStream tokens;
+        {
+            LLC_STATS_TIME(llc::StatPhase::Scan);
+            if (options.cache_dir.empty())
+            {
+                tokens = ss.ScanAllParallel(lex_workers);
+            }
+            else
+            {
+                llc::TokenCache cache(options.cache_dir);
+                tokens = ss.ScanAllCached(cache, lex_workers);
+            }
+        }
+        {
+            LLC_STATS_TIME(llc::StatPhase::Dump);
+            dumper.DumpTokens(tokens);
+            dumper.DumpDiagnostics(ss);
+        }
+        result.failed = ss.has_errors();
+    }
+}
+
+// Lexes through a bounded window, so memory does not grow with the input
+void StreamFile(const std::string& path, const Options& options, llc::TokenDumper& dumper, FileResult& result)
+{
+    std::ifstream file;
+    if (path != "-")
+    {
+        file.open(path, std::ios::binary);
+        if (!file.is_open())
+        {
+            result.err += "Cannot open '" + path + "'\n";
+            result.failed = true;
+            dumper.DumpUnreadable();
+            return;
+        }
+    }
+
+    llc::StreamScanner ss(path == "-" ? std::cin : file);
+    ss.set_max_diagnostics(options.max_diagnostics);
+    ss.set_engine(options.engine);
+    //Scanning and dumping interleave here, so both count as the scan phase
+    LLC_STATS_TIME(llc::StatPhase::Scan);
+    llc::Token token = ss.Scan();
+    for (; token.type != llc::TokenType::Eof; token = ss.Scan())
+    {
+        dumper.DumpToken(token);
+    }
+
+    llc::Span<const llc::Diagnostic> records = ss.diagnostics().records();
+    for (std::size_t i = 0; i < records.size(); ++i)
+    {
+        dumper.DumpDiagnostic(records[i], ss.diagnostic_coords()[i]);
+    }
+    for (const auto& x : ss.errors())
+    {
+        result.err += x->message() + "\n";
+    }
+    result.failed = ss.has_errors();
+}
+
+// Parses instead of dumping tokens, so only diagnostics are printed: the
+// scanner's first, then the parser's
+void ParseFile(const std::string& path, const Options& options, llc::TokenDumper& dumper, FileResult& result)
+{
+    llc::Scanner ss;
+    {
+        LLC_STATS_TIME(llc::StatPhase::Read);
+        ss.AttachFile(path);
+    }
+    ss.set_max_diagnostics(options.max_diagnostics);
+    ss.set_engine(options.engine);
+    if (ss.has_errors())
+    {
+        for (const auto& x : ss.errors())
+        {
+            result.err += x->message() + "\n";
+        }
+        result.failed = true;
+        dumper.DumpUnreadable();
+        return;
+    }
+
+    llc::Arena arena;
+    std::unique_ptr<llc::TokenPipeline> pipeline;
+    std::unique_ptr<llc::Parser> parser;
+    if (options.pipeline)
+    {
+        pipeline.reset(new llc::TokenPipeline(ss, false));
+        parser.reset(new llc::Parser(*pipeline, arena));
+    }
+    else
+    {
+        parser.reset(new llc::Parser(ss, arena));
+    }
+
+    {
+        LLC_STATS_TIME(llc::StatPhase::Parse);
+        parser->ParseProgram();
+
+        //Scan whatever the parser left over, so the scanner's diagnostics cover the whole file
+        if (pipeline)
+        {
+            pipeline->Finish();
+        }
+        else
+        {
+            while (ss.ScanWith<llc::CodeScanPolicy>().type != llc::TokenType::Eof)
+            {}
+        }
+    }
+
+    LLC_STATS_TIME(llc::StatPhase::Dump);
+    dumper.DumpDiagnostics(ss);
+    for (const llc::Diagnostic& d : parser->diagnostics().records())
+    {
+        dumper.DumpDiagnostic(d, ss.Locate(d.offset));
+    }
+    result.failed = ss.has_errors() || parser->has_errors();
+}
+
+// With a sink the dump streams straight to it, otherwise it is kept in result.out
+void CompileFile(const std::string& path, const Options& options, unsigned lex_workers,
+    std::FILE* sink, FileResult& result)
+{
+    llc::TokenDumper dumper(options.format, sink);
+    dumper.BeginFile(path);
+
+    if (options.stream)
+    {
+        StreamFile(path, options, dumper, result);
+    }
+    else if (options.parse)
+    {
+        ParseFile(path, options, dumper, result);
+    }
+    else
+    {
+        ScanFile(path, options, lex_workers, dumper, result);
+    }
+
+    if (sink == nullptr)
+    {
+        result.out.swap(dumper.buffer());
+    }
+}
 
 int main(int argc, char* argv[])
 {
-    if (argc < 2)
+    Options options;
+    if (!ParseArgs(argc, argv, options))
     {
-        std::cerr << "Expecting input file";
+        PrintUsage();
         exit(-1);
     }
 
-    std::cout << "Scanning " << argv[1] << std::endl;
-    llc::Scanner ss(argv[1]);
+    unsigned jobs = options.jobs == 0 ? llc::DefaultWorkerCount() : options.jobs;
+    //A single file gets the workers for parallel lexing instead, and streams its dump
+    bool single = options.files.size() == 1;
+    unsigned lex_workers = single ? jobs : 1;
+    std::FILE* sink = single ? stdout : nullptr;
 
-    llc::Token t = ss.Scan();
-    while (t.type != llc::TokenType::Eof)
+    std::vector<FileResult> results(options.files.size());
+    std::mutex mutex;
+    std::condition_variable finished;
+
+    std::thread compiling([&]()
     {
-        std::cout << t.GetName() << " " << t.value << std::endl;
-        t = ss.Scan();
+        llc::ParallelFor(results.size(), jobs, [&](std::size_t i)
+        {
+            FileResult result;
+            CompileFile(options.files[i], options, lex_workers, sink, result);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            results[i] = std::move(result);
+            results[i].done = true;
+            finished.notify_all();
+        });
+    });
+
+    //Print in command line order as soon as each file is ready
+    bool failed = false;
+    for (auto& result : results)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            finished.wait(lock, [&result]() { return result.done; });
+        }
+
+        std::fwrite(result.out.data(), 1, result.out.size(), stdout);
+        std::fflush(stdout);
+        std::cerr << result.err << std::flush;
+        failed |= result.failed;
+        result = FileResult();
     }
 
-    for (auto x : ss.warnings())
+    compiling.join();
+#ifdef LLC_STATS
+    if (options.stats)
     {
-        std::cout << x->message() << " " << x->coord().String() << std::endl;
+        std::cerr << llc::StatsJson() << std::endl;
     }
-}
\ No newline at end of file
+#endif
+    return failed ? -1 : 0;
+}
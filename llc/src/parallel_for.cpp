@@ -0,0 +1,60 @@
+// llc is a compiler for a toy language
+// Copyright (C) 2014  Logan Romantic
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "parallel_for.h"
+
+namespace llc
+{
+    unsigned DefaultWorkerCount()
+    {
+        unsigned n = std::thread::hardware_concurrency();
+        return n == 0 ? 1 : n;
+    }
+
+    void ParallelFor(std::size_t count, unsigned workers, const std::function<void(std::size_t)>& work)
+    {
+        if (workers == 0)
+        {
+            workers = DefaultWorkerCount();
+        }
+        workers = static_cast<unsigned>(std::min<std::size_t>(workers, count));
+
+        std::atomic<std::size_t> next(0);
+        auto drain = [&]()
+        {
+            for (std::size_t i = next++; i < count; i = next++)
+            {
+                work(i);
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (unsigned i = 1; i < workers; ++i)
+        {
+            threads.emplace_back(drain);
+        }
+        drain();
+
+        for (auto& t : threads)
+        {
+            t.join();
+        }
+    }
+}
@@ -0,0 +1,549 @@
+// llc is a compiler for a toy language
+// Copyright (C) 2014  Logan Romantic
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+#include "parser.h"
+
+namespace llc
+{
+    Parser::Parser(Scanner& scanner, Arena& arena)
+        : scanner_(&scanner), pipeline_(nullptr), arena_(arena), head_(0), count_(0), panic_(false)
+    {}
+
+    Parser::Parser(TokenPipeline& pipeline, Arena& arena)
+        : scanner_(nullptr), pipeline_(&pipeline), arena_(arena), head_(0), count_(0), panic_(false)
+    {}
+
+    //Fills the ring up to the requested token; ahead must be below kLookahead
+    const Token& Parser::Peek(std::size_t ahead)
+    {
+        while (count_ <= ahead)
+        {
+            Token token = pipeline_ != nullptr ? pipeline_->Next() : scanner_->ScanWith<CodeScanPolicy>();
+            if (token.type == TokenType::Comment || token.type == TokenType::Illegal)
+            {
+                continue;
+            }
+            ring_[(head_ + count_) & (kLookahead - 1)] = token;
+            count_ += 1;
+        }
+        return ring_[(head_ + ahead) & (kLookahead - 1)];
+    }
+
+    Token Parser::Next()
+    {
+        Token token = Peek();
+        head_ = (head_ + 1) & (kLookahead - 1);
+        count_ -= 1;
+        return token;
+    }
+
+    bool Parser::Accept(TokenType type)
+    {
+        if (At(type))
+        {
+            Next();
+            return true;
+        }
+        return false;
+    }
+
+    bool Parser::Expect(TokenType type)
+    {
+        if (Accept(type))
+        {
+            return true;
+        }
+        Report(DiagCode::ExpectedToken, type);
+        return false;
+    }
+
+    //Only the first error until the next synchronization point is reported
+    //A second error on the same token, typically Eof, only follows from the first
+    void Parser::Report(DiagCode code, TokenType arg)
+    {
+        std::uint32_t offset = Peek().offset;
+        bool repeated = !diagnostics_.empty() && diagnostics_.records()[diagnostics_.size() - 1].offset == offset;
+        if (!panic_ && !repeated)
+        {
+            diagnostics_.Report(code, offset, static_cast<char>(arg));
+        }
+        panic_ = true;
+    }
+
+    //Skips the rest of a broken declaration or statement, including its ';'
+    void Parser::Synchronize(bool declarations)
+    {
+        while (!At(TokenType::Eof) && !Accept(TokenType::SemiColon))
+        {
+            TokenType type = Peek().type;
+            if (declarations ? type == TokenType::Begin : type == TokenType::End || type == TokenType::Else)
+            {
+                break;
+            }
+            Next();
+        }
+        panic_ = false;
+    }
+
+    Program* Parser::ParseProgram()
+    {
+        Program* program = arena_.New<Program>();
+        program->offset = Peek().offset;
+
+        Expect(TokenType::Program);
+        Token name = Peek();
+        if (Expect(TokenType::Identifier))
+        {
+            program->name = name.value;
+            program->symbol = name.symbol;
+        }
+        Expect(TokenType::Is);
+        ParseBody(program->decls, program->body);
+        Expect(TokenType::Program);
+
+        if (!At(TokenType::Eof))
+        {
+            Report(DiagCode::ExpectedToken, TokenType::Eof);
+        }
+        return program;
+    }
+
+    void Parser::ParseBody(Decl*& decls, Stmt*& body)
+    {
+        decls = ParseDeclarations();
+        Expect(TokenType::Begin);
+        body = ParseStatements(false);
+        Expect(TokenType::End);
+    }
+
+    Decl* Parser::ParseDeclarations()
+    {
+        Decl* head = nullptr;
+        Decl** tail = &head;
+
+        while (!At(TokenType::Begin) && !At(TokenType::Eof))
+        {
+            Decl* decl = ParseDeclaration();
+            if (decl != nullptr)
+            {
+                *tail = decl;
+                tail = &decl->next;
+            }
+            if (!panic_)
+            {
+                Expect(TokenType::SemiColon);
+            }
+            if (panic_)
+            {
+                Synchronize(true);
+            }
+        }
+        return head;
+    }
+
+    Decl* Parser::ParseDeclaration()
+    {
+        std::uint32_t offset = Peek().offset;
+        bool global = Accept(TokenType::Global);
+
+        if (At(TokenType::Procedure))
+        {
+            return ParseProcedure(global, offset);
+        }
+        return ParseVariable(global, offset);
+    }
+
+    Decl* Parser::ParseProcedure(bool global, std::uint32_t offset)
+    {
+        Next();
+
+        Decl* decl = arena_.New<Decl>();
+        decl->kind = DeclKind::Procedure;
+        decl->global = global;
+        decl->offset = offset;
+
+        Token name = Peek();
+        if (Expect(TokenType::Identifier))
+        {
+            decl->name = name.value;
+            decl->symbol = name.symbol;
+        }
+
+        Expect(TokenType::Lparen);
+        if (!At(TokenType::Rparen))
+        {
+            Decl** tail = &decl->params;
+            do
+            {
+                Decl* param = ParseVariable(false, Peek().offset);
+                if (param == nullptr)
+                {
+                    break;
+                }
+                if (Accept(TokenType::In))
+                {
+                    param->mode = ParamMode::In;
+                }
+                else if (Accept(TokenType::Out))
+                {
+                    param->mode = ParamMode::Out;
+                }
+                else
+                {
+                    Report(DiagCode::ExpectedToken, TokenType::In);
+                }
+                *tail = param;
+                tail = &param->next;
+            } while (Accept(TokenType::Comma));
+        }
+        if (panic_)
+        {
+            //Resync on the end of a broken parameter list so the body still gets checked
+            while (!At(TokenType::Rparen) && !At(TokenType::Begin) && !At(TokenType::Eof))
+            {
+                Next();
+            }
+            panic_ = false;
+        }
+        Expect(TokenType::Rparen);
+
+        ParseBody(decl->decls, decl->body);
+        Expect(TokenType::Procedure);
+        return decl;
+    }
+
+    Decl* Parser::ParseVariable(bool global, std::uint32_t offset)
+    {
+        TokenType type = Peek().type;
+        if (type != TokenType::IntegerType && type != TokenType::FloatType
+            && type != TokenType::BoolType && type != TokenType::StringType)
+        {
+            Report(DiagCode::UnexpectedToken, type);
+            return nullptr;
+        }
+        Next();
+
+        Decl* decl = arena_.New<Decl>();
+        decl->kind = DeclKind::Variable;
+        decl->global = global;
+        decl->type_mark = type;
+        decl->offset = offset;
+
+        Token name = Peek();
+        if (Expect(TokenType::Identifier))
+        {
+            decl->name = name.value;
+            decl->symbol = name.symbol;
+        }
+
+        if (Accept(TokenType::Lbracket))
+        {
+            Token size = Peek();
+            if (Expect(TokenType::Integer))
+            {
+                decl->bound = NewLeaf(ExprKind::Integer, size);
+            }
+            Expect(TokenType::Rbracket);
+        }
+        return decl;
+    }
+
+    Stmt* Parser::ParseStatements(bool at_least_one)
+    {
+        Stmt* head = nullptr;
+        Stmt** tail = &head;
+
+        while (!At(TokenType::End) && !At(TokenType::Else) && !At(TokenType::Eof))
+        {
+            Stmt* stmt = ParseStatement();
+            if (stmt != nullptr)
+            {
+                *tail = stmt;
+                tail = &stmt->next;
+            }
+            if (!panic_)
+            {
+                Expect(TokenType::SemiColon);
+            }
+            if (panic_)
+            {
+                Synchronize(false);
+            }
+        }
+
+        if (at_least_one && head == nullptr)
+        {
+            Report(DiagCode::UnexpectedToken, Peek().type);
+        }
+        return head;
+    }
+
+    Stmt* Parser::ParseStatement()
+    {
+        Token token = Peek();
+        switch (token.type)
+        {
+        case TokenType::If:
+            return ParseIf();
+        case TokenType::For:
+            return ParseFor();
+        case TokenType::Return:
+        {
+            Next();
+            Stmt* stmt = arena_.New<Stmt>();
+            stmt->kind = StmtKind::Return;
+            stmt->offset = token.offset;
+            return stmt;
+        }
+        case TokenType::Identifier:
+            //The one place that needs a second token of lookahead
+            if (Peek(1).type == TokenType::Lparen)
+            {
+                return ParseCall(Next());
+            }
+            return ParseAssignment(ParseName());
+        default:
+            Report(DiagCode::UnexpectedToken, token.type);
+            return nullptr;
+        }
+    }
+
+    Stmt* Parser::ParseIf()
+    {
+        Stmt* stmt = arena_.New<Stmt>();
+        stmt->kind = StmtKind::If;
+        stmt->offset = Next().offset;
+
+        Expect(TokenType::Lparen);
+        stmt->value = ParseExpression();
+        Expect(TokenType::Rparen);
+        Expect(TokenType::Then);
+        stmt->body = ParseStatements(true);
+        if (Accept(TokenType::Else))
+        {
+            stmt->else_body = ParseStatements(true);
+        }
+        Expect(TokenType::End);
+        Expect(TokenType::If);
+        return stmt;
+    }
+
+    Stmt* Parser::ParseFor()
+    {
+        Stmt* stmt = arena_.New<Stmt>();
+        stmt->kind = StmtKind::For;
+        stmt->offset = Next().offset;
+
+        Expect(TokenType::Lparen);
+        stmt->init = ParseAssignment(ParseName());
+        Expect(TokenType::SemiColon);
+        stmt->value = ParseExpression();
+        Expect(TokenType::Rparen);
+        stmt->body = ParseStatements(false);
+        Expect(TokenType::End);
+        Expect(TokenType::For);
+        return stmt;
+    }
+
+    Stmt* Parser::ParseAssignment(Expr* target)
+    {
+        Stmt* stmt = arena_.New<Stmt>();
+        stmt->kind = StmtKind::Assign;
+        stmt->offset = target != nullptr ? target->offset : Peek().offset;
+        stmt->target = target;
+
+        Expect(TokenType::Assign);
+        stmt->value = ParseExpression();
+        return stmt;
+    }
+
+    Stmt* Parser::ParseCall(const Token& name)
+    {
+        Stmt* stmt = arena_.New<Stmt>();
+        stmt->kind = StmtKind::Call;
+        stmt->offset = name.offset;
+        stmt->name = name.value;
+        stmt->symbol = name.symbol;
+
+        Expect(TokenType::Lparen);
+        if (!At(TokenType::Rparen))
+        {
+            Expr** tail = &stmt->args;
+            do
+            {
+                Expr* arg = ParseExpression();
+                if (arg != nullptr)
+                {
+                    *tail = arg;
+                    tail = &arg->next;
+                }
+            } while (Accept(TokenType::Comma));
+        }
+        Expect(TokenType::Rparen);
+        return stmt;
+    }
+
+    Expr* Parser::ParseExpression()
+    {
+        Expr* left;
+        if (At(TokenType::Not))
+        {
+            left = arena_.New<Expr>();
+            left->kind = ExprKind::Not;
+            left->offset = Next().offset;
+            left->left = ParseArith();
+        }
+        else
+        {
+            left = ParseArith();
+        }
+
+        while (At(TokenType::And) || At(TokenType::Or))
+        {
+            TokenType op = Next().type;
+            left = NewBinary(op, left, ParseArith());
+        }
+        return left;
+    }
+
+    Expr* Parser::ParseArith()
+    {
+        Expr* left = ParseRelation();
+        while (At(TokenType::Add) || At(TokenType::Sub))
+        {
+            TokenType op = Next().type;
+            left = NewBinary(op, left, ParseRelation());
+        }
+        return left;
+    }
+
+    Expr* Parser::ParseRelation()
+    {
+        Expr* left = ParseTerm();
+        for (;;)
+        {
+            TokenType op = Peek().type;
+            if (op != TokenType::Less && op != TokenType::LessEql && op != TokenType::Greater
+                && op != TokenType::GreaterEql && op != TokenType::Eql && op != TokenType::Neq)
+            {
+                return left;
+            }
+            Next();
+            left = NewBinary(op, left, ParseTerm());
+        }
+    }
+
+    Expr* Parser::ParseTerm()
+    {
+        Expr* left = ParseFactor();
+        while (At(TokenType::Mul) || At(TokenType::Div))
+        {
+            TokenType op = Next().type;
+            left = NewBinary(op, left, ParseFactor());
+        }
+        return left;
+    }
+
+    //Returns null after reporting an error
+    Expr* Parser::ParseFactor()
+    {
+        Token token = Peek();
+        switch (token.type)
+        {
+        case TokenType::Lparen:
+        {
+            Next();
+            Expr* expr = ParseExpression();
+            Expect(TokenType::Rparen);
+            return expr;
+        }
+        case TokenType::Sub:
+        {
+            Next();
+            Expr* expr = arena_.New<Expr>();
+            expr->kind = ExprKind::Negate;
+            expr->offset = token.offset;
+            if (At(TokenType::Integer) || At(TokenType::Float))
+            {
+                Token number = Next();
+                expr->left = NewLeaf(number.type == TokenType::Integer ? ExprKind::Integer : ExprKind::Float, number);
+            }
+            else
+            {
+                expr->left = ParseName();
+            }
+            return expr;
+        }
+        case TokenType::Identifier:
+            return ParseName();
+        case TokenType::Integer:
+            return NewLeaf(ExprKind::Integer, Next());
+        case TokenType::Float:
+            return NewLeaf(ExprKind::Float, Next());
+        case TokenType::String:
+            return NewLeaf(ExprKind::String, Next());
+        case TokenType::TrueKey:
+        case TokenType::FalseKey:
+        {
+            Expr* expr = NewLeaf(ExprKind::Bool, Next());
+            expr->literal.integer = token.type == TokenType::TrueKey ? 1 : 0;
+            return expr;
+        }
+        default:
+            Report(DiagCode::UnexpectedToken, token.type);
+            return nullptr;
+        }
+    }
+
+    Expr* Parser::ParseName()
+    {
+        Token token = Peek();
+        if (!Expect(TokenType::Identifier))
+        {
+            return nullptr;
+        }
+
+        Expr* expr = NewLeaf(ExprKind::Name, token);
+        if (Accept(TokenType::Lbracket))
+        {
+            expr->left = ParseExpression();
+            Expect(TokenType::Rbracket);
+        }
+        return expr;
+    }
+
+    Expr* Parser::NewBinary(TokenType op, Expr* left, Expr* right)
+    {
+        Expr* expr = arena_.New<Expr>();
+        expr->kind = ExprKind::Binary;
+        expr->op = op;
+        expr->offset = left != nullptr ? left->offset : Peek().offset;
+        expr->left = left;
+        expr->right = right;
+        return expr;
+    }
+
+    Expr* Parser::NewLeaf(ExprKind kind, const Token& token)
+    {
+        Expr* expr = arena_.New<Expr>();
+        expr->kind = kind;
+        expr->offset = token.offset;
+        expr->symbol = token.symbol;
+        expr->text = token.value;
+        expr->literal = token.literal;
+        return expr;
+    }
+}
@@ -14,13 +14,16 @@
 // You should have received a copy of the GNU General Public License
 // along with this program; if not, write to the Free Software
 // Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
-#include <cctype>
+#include <algorithm>
 #include <cstdio>
 #include <string>
-#include <sstream>
-#include <fstream>
 #include <iterator>
+#include <limits>
+#include "chars.h"
+#include "literals.h"
 #include "scanner.h"
+#include "simd.h"
+#include "stats.h"
 #include "token.h"
 
 using llc::Token;
@@ -29,38 +32,27 @@ using llc::Coord;
 
 namespace llc 
 {
-    char EOF_CHAR = (char) -1;
-
-    Warning::Warning(std::string message, Coord coord) 
+    Error::Error(std::string message, Coord coord) 
         : message_(message), coord_(coord) 
     {}
 
-    Warning::~Warning()
+    Error::~Error()
     {}
 
-    std::string hGenerateUnexpected(char c)
-    {
-        std::ostringstream ss;
-        ss << "Unexpected value '" << c << "'";
-        return ss.str();
-    }
-
-    std::string hGenerateCharNotAllowed(char c)
-    {
-        std::ostringstream ss;
-        ss << "Character '" << c << "' is not allowed in string";
-        return ss.str();
-    }
-
     Scanner::Scanner()
+        : input_(nullptr), size_(0), max_diagnostics_(0),
+          engine_(ScanEngine::Handwritten), interner_(&own_interner_)
     {
         Init();
+        NextChar();
     }
 
     Scanner::~Scanner()
     {}
 
     Scanner::Scanner(std::string filepath)
+        : input_(nullptr), size_(0), max_diagnostics_(0),
+          engine_(ScanEngine::Handwritten), interner_(&own_interner_)
     {
         AttachFile(filepath);
     }
@@ -68,237 +60,359 @@ namespace llc
     void Scanner::Init() 
     {
         offset_ = 0;
-        offset_ = 0;
-        line_ = 1;
-        column_ = 0;
+        lines_.Clear();
         has_errors_ = false;
     }
 
     void Scanner::AttachFile(std::string filepath)
     {
-        std::ifstream file(filepath, std::ios::binary);
+        diagnostics_.Clear();
+        errors_.clear();
 
-        typedef std::vector<char>::size_type size_type;
+        bool opened = source_.Open(filepath);
+        input_ = source_.data();
+        size_ = source_.size();
 
-        if (file.is_open())
-        {
-            file.seekg(0, file.end);
-            size_type size = static_cast<size_type>(file.tellg());
-            file.seekg(0, file.beg);
-            input_.resize(size);
-            file.read(&input_[0], size);
+        Init();
+        NextChar();
 
-            Init();
-            NextChar();
-        }
-        else
+        if (!opened)
         {
-            //error
+            has_errors_ = true;
+            errors_.push_back(std::make_shared<Error>(source_.error(), Coord()));
         }
     }
 
+    //The buffer is not copied and must outlive the scanner's tokens. Scanning
+    //starts at start, which must be between two tokens.
+    void Scanner::AttachBuffer(const char* data, std::size_t size, std::size_t start)
+    {
+        diagnostics_.Clear();
+        errors_.clear();
+        source_.Close();
+
+        input_ = data;
+        size_ = size;
+
+        Init();
+        offset_ = static_cast<unsigned int>(start);
+        NextChar();
+    }
+
+    void Scanner::Reset(const char* data, std::size_t size)
+    {
+        own_interner_.Clear();
+        AttachBuffer(data, size);
+    }
+
     Token Scanner::Scan()
     {
-        SkipWhitespace();
+        return ScanWith<DefaultScanPolicy>();
+    }
 
+    template <typename Policy>
+    Token Scanner::ScanWith()
+    {
+#ifdef LLC_STATS
+        std::size_t scan_start = Position();
+#endif
         Token token;
-        FreezePosition(token.coord);
 
-        if (char_ == EOF_CHAR) 
-        {
-            token.type = TokenType::Eof;
-            token.value = "";
-        }
-        else if (char_ == '/')
-        {
-            ScanComment(token);
-        }
-        else if (std::isalpha(char_))
+        //Only loops again after a skipped comment
+        for (;;)
         {
-            ScanIdentifier(token);
-        }
-        else if (std::isdigit(char_))
-        {
-            ScanNumber(token);
-        }
-        else if (char_ == '\"')
-        {
-            ScanString(token);
+            SkipWhitespace();
+            token.offset = static_cast<std::uint32_t>(Position());
+
+            std::uint8_t cls = ClassOf(char_);
+
+            if (engine_ == ScanEngine::Dfa)
+            {
+                ScanTable<Policy>(token);
+            }
+            else if (AtEnd()) 
+            {
+                token.type = TokenType::Eof;
+                token.value = Slice(Position());
+            }
+            else if (cls & kIdentStart)
+            {
+                ScanIdentifier(token);
+            }
+            else if (cls & kDigit)
+            {
+                ScanNumber(token);
+            }
+            else if (char_ == '/' && Peek() == '/')
+            {
+                if constexpr (Policy::kComments)
+                {
+                    ScanComment(token);
+                }
+                else
+                {
+                    SkipComment();
+                    continue;
+                }
+            }
+            else if (cls & kSymbolStart)
+            {
+                ScanSymbol<Policy>(token);
+            }
+            else if (char_ == '\"')
+            {
+                ScanString(token);
+            }
+            else 
+            {
+                ScanIllegal<Policy>(token);
+            }
+            break;
         }
-        else 
+
+        if (max_diagnostics_ != 0 && diagnostics_.size() >= max_diagnostics_ && !AtEnd())
         {
-            ScanSymbol(token);
+            Report(DiagCode::TooManyDiagnostics, token.offset);
+            Stop();
         }
 
+        LLC_STATS_ADD(bytes, Position() - scan_start);
+        LLC_STATS_ADD(tokens, 1);
+        LLC_STATS_ADD(token_types[static_cast<std::size_t>(token.type)], 1);
         return token;
     }
 
+    template Token Scanner::ScanWith<ScanPolicy<true, true>>();
+    template Token Scanner::ScanWith<ScanPolicy<true, false>>();
+    template Token Scanner::ScanWith<ScanPolicy<false, true>>();
+    template Token Scanner::ScanWith<ScanPolicy<false, false>>();
+
+    const std::size_t kDensitySample = 1 << 14;
+
+    //The columns are sized once from the bytes per token of the first
+    //tokens, plus an eighth; if the rest is denser they grow as usual
+    TokenStream Scanner::ScanAll()
+    {
+        TokenStream stream(input_);
+        std::size_t begin = Position();
+        stream.Reserve(std::min(kDensitySample, size_ - begin + 1));
+
+        Token token;
+        do
+        {
+            token = Scan();
+            stream.Push(token);
+            if (stream.size() == kDensitySample)
+            {
+                std::size_t rest = (size_ - Position()) * kDensitySample / (Position() - begin);
+                stream.Reserve(kDensitySample + rest + rest / 8);
+            }
+        } while (token.type != TokenType::Eof);
+
+        return stream;
+    }
+
     void Scanner::NextChar()
     {
-        if (offset_ >= input_.size())
+        if (offset_ >= size_)
         {
             char_ = EOF_CHAR;
+            offset_ = size_ + 1;
         }
         else 
         {
             char_ = input_[offset_];
             offset_ += 1;
-            column_ += 1;
-
-            if (char_ == '\n')
-            {
-                line_ += 1;
-                column_ = 0;
-            }
         }
     }
 
     char Scanner::Peek()
     {
-        if (offset_ >= input_.size())
+        if (offset_ >= size_)
         {
             return EOF_CHAR;
         }
         return input_[offset_];
     }
 
-    void Scanner::FreezePosition(Coord& coord)
+    std::string_view Scanner::Slice(std::size_t start) const
     {
-        coord.line = line_;
-        coord.column = column_;
+        return std::string_view(input_ + start, Position() - start);
     }
 
-    void Scanner::SkipWhitespace()
+    Coord Scanner::Locate(std::uint32_t offset) const
     {
-        while (std::isspace(char_))
+        if (!lines_.built())
         {
-            NextChar();
+            lines_.Build(input_, size_);
         }
+        return lines_.Locate(offset);
     }
 
-    void Scanner::ScanComment(Token& token)
+    void Scanner::AdvanceTo(const char* p)
     {
-        std::ostringstream ss;
-        while (char_ != '\n')
+        offset_ = static_cast<unsigned int>(p - input_);
+        NextChar();
+    }
+
+    void Scanner::SkipWhitespace()
+    {
+        LLC_STATS_TIME(StatRoutine::SkipWhitespace);
+        if (HasClass(char_, kWhitespace))
         {
-            ss << char_;
-            NextChar();
+            AdvanceTo(SkipWhitespaceRun(input_ + offset_, input_ + size_));
         }
+    }
+
+    void Scanner::ScanComment(Token& token)
+    {
+        LLC_STATS_TIME(StatRoutine::ScanComment);
+        std::size_t start = Position();
+        AdvanceTo(FindNewline(input_ + offset_, input_ + size_));
 
         token.type = TokenType::Comment;
-        token.value = ss.str();
+        token.value = Slice(start);
+    }
+
+    void Scanner::SkipComment()
+    {
+        LLC_STATS_TIME(StatRoutine::ScanComment);
+        AdvanceTo(FindNewline(input_ + offset_, input_ + size_));
     }
 
     void Scanner::ScanIdentifier(Token& token)
     {
-        std::ostringstream ss;
-        while (char_ == '_' | std::isalnum(char_))
-        {
-            ss << char_;
-            NextChar();
-        }
+        LLC_STATS_TIME(StatRoutine::ScanIdentifier);
+        std::size_t start = Position();
+        AdvanceTo(SkipIdentifierRun(input_ + offset_, input_ + size_));
 
-        token.value = ss.str();
+        token.value = Slice(start);
         token.type = Token::LookupIdentifier(token.value);
+        if (token.type == TokenType::Identifier)
+        {
+            token.symbol = interner_->Intern(token.value);
+        }
     }
 
-    void Scanner::ScanNumberPart(std::ostringstream& ss)
+    void Scanner::ScanNumberPart()
     {
-        while (char_ == '_' | std::isdigit(char_))
+        while (HasClass(char_, kNumberContinue))
         {
-            if (char_ != '_')
-            {
-                ss << char_;
-            }
             NextChar();
         }    
     }
 
     void Scanner::ScanNumber(Token& token)
     {
-        std::ostringstream ss;
-
-        ScanNumberPart(ss);
-        token.type = TokenType::Integer;
+        LLC_STATS_TIME(StatRoutine::ScanNumber);
+        const std::uint64_t max = std::numeric_limits<std::uint64_t>::max();
+        std::size_t start = Position();
+
+        //The integer part is converted while it is consumed
+        std::uint64_t value = 0;
+        bool fits = true;
+        while (HasClass(char_, kNumberContinue))
+        {
+            if (char_ != '_')
+            {
+                std::uint64_t digit = static_cast<std::uint64_t>(char_ - '0');
+                fits = fits && value <= (max - digit) / 10;
+                value = value * 10 + digit;
+            }
+            NextChar();
+        }
 
-        bool is_float = false;
         if (char_ == '.')
         {
-            is_float = true;
+            NextChar();
+            ScanNumberPart();
             token.type = TokenType::Float;
-            ScanNumberPart(ss);
+            token.value = Slice(start);
+            fits = DecodeLiteral(TokenType::Float, token.value, token.literal);
+        }
+        else
+        {
+            token.type = TokenType::Integer;
+            token.value = Slice(start);
+            token.literal.integer = value;
         }
 
-        token.value = ss.str();
+        if (!fits)
+        {
+            Report(DiagCode::NumberOutOfRange, token.offset);
+            token.type = TokenType::Illegal;
+        }
     }
 
     void Scanner::ScanString(Token& token)
     {
+        LLC_STATS_TIME(StatRoutine::ScanString);
         NextChar();
 
-        bool skip_next = false;
-        std::string allowed_chars = " _,;:.'";
-        std::ostringstream ss;
+        std::size_t start = Position();
+        bool malformed = false;
 
         while (char_ != '"') 
         {
-            if (char_ == EOF_CHAR | char_ == '\n') 
+            if (AtEnd() || char_ == '\n') 
             {
-                skip_next = true;
-                warnings_.push_back(std::make_shared<Warning>("Unterminated string", token.coord));
-                break;
+                Report(DiagCode::UnterminatedString, token.offset);
+                token.type = TokenType::Illegal;
+                token.value = Slice(token.offset);
+                return;
             }
             
-            if (!std::isalnum(char_) | allowed_chars.find(char_) == std::string::npos)
+            if (!malformed && !HasClass(char_, kStringChar))
             {
-                skip_next = true;
-                std::string message = hGenerateCharNotAllowed(char_);
-                warnings_.push_back(std::make_shared<Warning>(message, token.coord));
-                break;
+                //Report once, then resync on the closing quote or end of line
+                malformed = true;
+                Report(DiagCode::CharNotAllowed, token.offset, char_);
             }
 
-            ss << char_;
             NextChar();
         }
 
-        if (!skip_next)
+        if (malformed)
         {
-            //Consume trailing quote
             NextChar();
+            token.type = TokenType::Illegal;
+            token.value = Slice(token.offset);
+            return;
         }
 
         token.type = TokenType::String;
-        token.value = ss.str();
+        token.value = Slice(start);
+        token.symbol = interner_->Intern(token.value);
+
+        //Consume trailing quote
+        NextChar();
     }
 
+    template <typename Policy>
     void Scanner::ScanSymbol(Token& token)
     {
+        LLC_STATS_TIME(StatRoutine::ScanSymbol);
+        std::size_t start = Position();
         char c;
         switch (char_)
         {
         case ';':
             token.type = TokenType::SemiColon;
-            token.value = ";";
             break;
         case ',':
             token.type = TokenType::Comma;
-            token.value = ";";
             break;
         case '(':
             token.type = TokenType::Lparen;
-            token.value = "(";
             break;
         case ')':
             token.type = TokenType::Rparen;
-            token.value = ")";
             break;
         case '[':
             token.type = TokenType::Lbracket;
-            token.value = "[";
             break;
         case ']':
             token.type = TokenType::Rbracket;
-            token.value = "]";
             break;
         case ':':
             c = Peek();
@@ -306,49 +420,39 @@ namespace llc
             {
                 NextChar();
                 token.type = TokenType::Assign;
-                token.value = ":=";
             }
             else
             {
-                std::string message = hGenerateUnexpected(c);
-                warnings_.push_back(std::make_shared<Warning>(message, token.coord));
+                Warn<Policy>(DiagCode::UnexpectedChar, token.offset, c);
             }
             break;
         case '|':
             token.type = TokenType::Or;
-            token.value = "|";
             break;
         case '&':
             token.type = TokenType::And;
-            token.value = "&";
             break;
         case '+':
             token.type = TokenType::Add;
-            token.value = "+";
             break;
         case '-':
             token.type = TokenType::Sub;
-            token.value = "-";
             break;
         case '*':
             token.type = TokenType::Mul;
-            token.value = "*";
             break;
         case '/':
             token.type = TokenType::Div;
-            token.value = "/";
             break;
         case '<':
             if (Peek() == '=')
             {
                 NextChar();
                 token.type = TokenType::LessEql;
-                token.value = "<=";
             }
             else
             {
                 token.type = TokenType::Less;
-                token.value = "<";
             }
             break;
         case '>':
@@ -356,12 +460,10 @@ namespace llc
             {
                 NextChar();
                 token.type = TokenType::GreaterEql;
-                token.value = ">=";
             }
             else
             {
                 token.type = TokenType::Greater;
-                token.value = ">";
             }
             break;
         case '=':
@@ -370,12 +472,10 @@ namespace llc
             {
                 NextChar();
                 token.type = TokenType::Eql;
-                token.value = "==";
             }
             else
             {
-                std::string message = hGenerateUnexpected(c);
-                warnings_.push_back(std::make_shared<Warning>(message, token.coord));
+                Warn<Policy>(DiagCode::UnexpectedChar, token.offset, c);
             }
             break;
         case '!':
@@ -384,18 +484,42 @@ namespace llc
             {
                 NextChar();
                 token.type = TokenType::Neq;
-                token.value = "!=";
             }
             else
             {
-                std::string message = hGenerateUnexpected(c);
-                warnings_.push_back(std::make_shared<Warning>(message, token.coord));
+                Warn<Policy>(DiagCode::UnexpectedChar, token.offset, c);
             }
             break;
-        default:
-            std::string message = hGenerateUnexpected(char_);
-            warnings_.push_back(std::make_shared<Warning>(message, token.coord));
         }
         NextChar();
+        token.value = Slice(start);
+    }
+
+    void Scanner::Report(DiagCode code, std::uint32_t offset, char arg)
+    {
+        diagnostics_.Report(code, offset, arg);
+        if (Diagnostics::SeverityOf(code) == Severity::Error)
+        {
+            has_errors_ = true;
+        }
+    }
+
+    //Pretend the input ends at the current position
+    void Scanner::Stop()
+    {
+        size_ = Position();
+        char_ = EOF_CHAR;
+    }
+
+    template <typename Policy>
+    void Scanner::ScanIllegal(Token& token)
+    {
+        LLC_STATS_TIME(StatRoutine::ScanIllegal);
+        std::size_t start = Position();
+        Warn<Policy>(DiagCode::UnexpectedChar, token.offset, char_);
+
+        NextChar();
+        token.type = TokenType::Illegal;
+        token.value = Slice(start);
     }
 }
\ No newline at end of file
@@ -0,0 +1,46 @@
+// llc is a compiler for a toy language
+// Copyright (C) 2014  Logan Romantic
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+#include "scanner.h"
+#include "token_cache.h"
+
+namespace llc
+{
+    //Only whole-buffer scans without a diagnostic limit are cached
+    TokenStream Scanner::ScanAllCached(TokenCache& cache, unsigned workers)
+    {
+        bool cacheable = Position() == 0 && max_diagnostics_ == 0;
+
+        if (cacheable)
+        {
+            TokenStream stream(input_);
+            if (cache.Load(input_, size_, stream, diagnostics_, *interner_))
+            {
+                has_errors_ = has_errors_ || diagnostics_.error_count() > 0;
+                offset_ = static_cast<unsigned int>(size_);
+                NextChar();
+                return stream;
+            }
+        }
+
+        TokenStream stream = ScanAllParallel(workers);
+        if (cacheable)
+        {
+            cache.Store(input_, size_, stream, diagnostics_, *interner_);
+        }
+        return stream;
+    }
+}
@@ -0,0 +1,174 @@
+// llc is a compiler for a toy language
+// Copyright (C) 2014  Logan Romantic
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+#include <algorithm>
+#include <vector>
+#include "scanner.h"
+#include "simd.h"
+#include "parallel_for.h"
+
+// Parallel lexing splits the input into chunks that start right after a
+// newline and scans each one independently, assuming the scanner is
+// between tokens there. That assumption holds for the current lexical
+// rules (no token contains a newline), but it is still checked: a chunk
+// whose last token ran into the chunk end means the next chunk started
+// mid-token, so that token and the next chunk are scanned again as one
+// range. Only such chunks are re-scanned.
+
+namespace llc
+{
+    const std::size_t kMinChunkSize = 1 << 20;
+    const unsigned kChunksPerWorker = 4;
+
+    struct Scanner::Chunk
+    {
+        Chunk() : count(0), symbol_count(0), last_start(0), clean(true) {}
+
+        TokenStream tokens;
+        Diagnostics diagnostics;
+        Interner symbols;
+        std::size_t count;
+        std::size_t symbol_count;
+        std::uint32_t last_start;
+        bool clean;
+    };
+
+    void Scanner::ScanChunk(const char* input, std::size_t begin, std::size_t end, ScanEngine engine, Chunk& chunk)
+    {
+        Scanner scanner;
+        scanner.set_engine(engine);
+        scanner.AttachBuffer(input, end, begin);
+
+        chunk.tokens = scanner.ScanAll();
+        chunk.diagnostics = scanner.diagnostics_;
+        chunk.symbols = std::move(scanner.own_interner_);
+        chunk.symbol_count = chunk.symbols.size();
+        chunk.count = chunk.tokens.size() - 1;
+        chunk.clean = true;
+
+        if (chunk.count > 0)
+        {
+            //Re-run the last token to see whether it stopped at the chunk end
+            Scanner probe;
+            probe.set_engine(engine);
+            chunk.last_start = chunk.tokens.offset(chunk.count - 1);
+            probe.AttachBuffer(input, end, chunk.last_start);
+            probe.Scan();
+            chunk.clean = probe.Position() < end;
+        }
+    }
+
+    std::vector<std::size_t> hSplitChunks(const char* input, std::size_t begin, std::size_t end, std::size_t chunks)
+    {
+        std::vector<std::size_t> bounds(1, begin);
+        std::size_t step = (end - begin) / chunks;
+
+        for (std::size_t i = 1; i < chunks; ++i)
+        {
+            std::size_t target = std::max(begin + i * step, bounds.back());
+            const char* nl = FindNewline(input + target, input + end);
+            std::size_t bound = static_cast<std::size_t>(nl - input) + 1;
+            if (bound < end && bound > bounds.back())
+            {
+                bounds.push_back(bound);
+            }
+        }
+
+        bounds.push_back(end);
+        return bounds;
+    }
+
+    TokenStream Scanner::ScanAllParallel(unsigned workers)
+    {
+        if (workers == 0)
+        {
+            workers = DefaultWorkerCount();
+        }
+
+        std::size_t begin = Position();
+        std::size_t chunks = std::min<std::size_t>(workers * kChunksPerWorker, (size_ - begin) / kMinChunkSize);
+        //A diagnostic limit stops at the first chunk that reaches it, so scan in order
+        if (workers < 2 || chunks < 2 || max_diagnostics_ != 0)
+        {
+            return ScanAll();
+        }
+
+        std::vector<std::size_t> bounds = hSplitChunks(input_, begin, size_, chunks);
+        std::vector<Chunk> results(bounds.size() - 1);
+
+        ParallelFor(results.size(), workers, [&](std::size_t i)
+        {
+            ScanChunk(input_, bounds[i], bounds[i + 1], engine_, results[i]);
+        });
+
+        for (std::size_t i = 1; i < results.size(); ++i)
+        {
+            Chunk& previous = results[i - 1];
+            if (previous.clean)
+            {
+                continue;
+            }
+
+            //Wrong guess: chunk i started inside previous's last token
+            std::uint32_t restart = previous.last_start;
+            previous.count -= 1;
+            previous.symbol_count = previous.tokens.SymbolsBefore(previous.count);
+            previous.diagnostics.Truncate(previous.diagnostics.LowerBound(restart));
+
+            results[i] = Chunk();
+            ScanChunk(input_, restart, bounds[i + 1], engine_, results[i]);
+        }
+
+        std::vector<std::size_t> at(results.size() + 1, 0);
+        std::vector<std::uint32_t> literal_at(results.size() + 1, 0);
+        for (std::size_t i = 0; i < results.size(); ++i)
+        {
+            at[i + 1] = at[i] + results[i].count;
+            literal_at[i + 1] = literal_at[i] + results[i].tokens.LiteralsBefore(results[i].count);
+            diagnostics_.Append(results[i].diagnostics.records());
+        }
+
+        //Chunk symbols join in chunk order, which gives the IDs a sequential scan would
+        std::vector<std::vector<std::uint32_t>> symbol_maps(results.size());
+        for (std::size_t i = 0; i < results.size(); ++i)
+        {
+            symbol_maps[i].resize(results[i].symbol_count);
+            for (std::uint32_t id = 0; id < results[i].symbol_count; ++id)
+            {
+                symbol_maps[i][id] = interner_->Intern(results[i].symbols.Name(id));
+            }
+        }
+        has_errors_ = has_errors_ || diagnostics_.error_count() > 0;
+
+        TokenStream stream(input_);
+        stream.Resize(at.back());
+        stream.ResizeLiterals(literal_at.back());
+        ParallelFor(results.size(), workers, [&](std::size_t i)
+        {
+            stream.CopyFrom(results[i].tokens, 0, results[i].count, at[i], literal_at[i], symbol_maps[i]);
+        });
+
+        offset_ = static_cast<unsigned int>(size_);
+        NextChar();
+
+        Token eof;
+        eof.type = TokenType::Eof;
+        eof.offset = static_cast<std::uint32_t>(size_);
+        eof.value = Slice(size_);
+        stream.Push(eof);
+        return stream;
+    }
+}
@@ -0,0 +1,313 @@
+// llc is a compiler for a toy language
+// Copyright (C) 2014  Logan Romantic
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+#include <limits>
+#include "chars.h"
+#include "literals.h"
+#include "scanner.h"
+#include "simd.h"
+#include "stats.h"
+#include "token_names.h"
+
+// The Dfa engine. A token is recognized by walking a transition table one
+// byte at a time, with no per-character branching beyond the table lookup
+// and the end-of-input test; the state it stops in then selects the action
+// that builds the token. The table is computed at compile time from the
+// character classes in chars.h and the symbol spellings in token_names.h,
+// so new operators only need a TokenType and a name.
+//
+// Strings are only recognized here: their recovery rules live in
+// Scanner::ScanString, which both engines share. Comment bodies are skipped
+// with the FindNewline kernel instead of the table, as byte steps lose
+// badly to memchr on long comments.
+
+namespace llc
+{
+    enum TableAction : std::uint8_t
+    {
+        kActionStart,        //Stopped before consuming anything: end of input or an illegal byte
+        kActionIdentifier,
+        kActionInteger,
+        kActionFloat,
+        kActionComment,
+        kActionString,
+        kActionSymbol,
+        kActionIncomplete,   //A prefix of a symbol that is not a symbol itself, like ':'
+    };
+
+    const std::size_t kMaxStates = 64;
+    const std::size_t kEndColumn = 256;
+    const std::uint8_t kStop = 0xFF;
+
+    enum TableState : std::uint8_t
+    {
+        kStateStart,
+        kStateIdentifier,
+        kStateInteger,
+        kStateFloat,
+        kStateComment,
+        kStateQuote,
+        kFirstSymbolState,
+    };
+
+    struct TransitionTable
+    {
+        std::uint8_t next[kMaxStates][kEndColumn + 1];
+        TableAction action[kMaxStates];
+        TokenType accept[kMaxStates];
+        std::size_t states;
+        bool complete;
+    };
+
+    constexpr void hLoop(TransitionTable& table, std::uint8_t state, CharClass cls)
+    {
+        for (std::size_t c = 0; c < kEndColumn; ++c)
+        {
+            if (char_classes.classes[c] & cls)
+            {
+                table.next[state][c] = state;
+            }
+        }
+    }
+
+    constexpr TransitionTable hBuildTransitionTable()
+    {
+        TransitionTable table = {};
+        table.complete = true;
+        for (auto& row : table.next)
+        {
+            for (auto& next : row)
+            {
+                next = kStop;
+            }
+        }
+
+        table.action[kStateStart] = kActionStart;
+        table.action[kStateIdentifier] = kActionIdentifier;
+        table.action[kStateInteger] = kActionInteger;
+        table.action[kStateFloat] = kActionFloat;
+        table.action[kStateComment] = kActionComment;
+        table.action[kStateQuote] = kActionString;
+        table.states = kFirstSymbolState;
+
+        for (std::size_t c = 0; c < kEndColumn; ++c)
+        {
+            std::uint8_t cls = char_classes.classes[c];
+            if (cls & kIdentStart)
+            {
+                table.next[kStateStart][c] = kStateIdentifier;
+            }
+            else if (cls & kDigit)
+            {
+                table.next[kStateStart][c] = kStateInteger;
+            }
+        }
+        table.next[kStateStart][static_cast<unsigned char>('"')] = kStateQuote;
+        hLoop(table, kStateIdentifier, kIdentContinue);
+        hLoop(table, kStateInteger, kNumberContinue);
+        table.next[kStateInteger][static_cast<unsigned char>('.')] = kStateFloat;
+        hLoop(table, kStateFloat, kNumberContinue);
+
+        //One chain of states per symbol spelling, sharing common prefixes
+        for (std::size_t t = static_cast<std::size_t>(TokenType::SemiColon); t <= static_cast<std::size_t>(TokenType::Neq); ++t)
+        {
+            std::uint8_t state = kStateStart;
+            for (char c : token_names[t].name)
+            {
+                std::uint8_t& next = table.next[state][static_cast<unsigned char>(c)];
+                if (next == kStop)
+                {
+                    if (table.states == kMaxStates)
+                    {
+                        table.complete = false;
+                        return table;
+                    }
+                    next = static_cast<std::uint8_t>(table.states++);
+                    table.action[next] = kActionIncomplete;
+                }
+                state = next;
+            }
+            table.action[state] = kActionSymbol;
+            table.accept[state] = static_cast<TokenType>(t);
+        }
+
+        //"//" starts a comment rather than two divisions
+        std::uint8_t slash = table.next[kStateStart][static_cast<unsigned char>('/')];
+        table.next[slash][static_cast<unsigned char>('/')] = kStateComment;
+
+        //Every symbol start must lead somewhere, or the engines would disagree
+        for (std::size_t c = 0; c < kEndColumn; ++c)
+        {
+            if ((char_classes.classes[c] & kSymbolStart) && table.next[kStateStart][c] == kStop)
+            {
+                table.complete = false;
+            }
+        }
+        return table;
+    }
+
+    constexpr TransitionTable transitions = hBuildTransitionTable();
+    static_assert(transitions.complete, "symbol spellings do not fit the transition table");
+
+    template <typename Policy>
+    void Scanner::ScanTable(Token& token)
+    {
+        LLC_STATS_TIME(StatRoutine::ScanTable);
+
+        const char* start = input_ + token.offset;
+        const char* end = input_ + size_;
+        const char* p = start;
+        std::uint8_t state;
+
+        //Only loops again after a skipped comment
+        for (;;)
+        {
+            state = kStateStart;
+            for (;;)
+            {
+                std::size_t column = p < end ? static_cast<unsigned char>(*p) : kEndColumn;
+                std::uint8_t next = transitions.next[state][column];
+                if (next == kStop)
+                {
+                    break;
+                }
+                state = next;
+                ++p;
+            }
+
+            if constexpr (!Policy::kComments)
+            {
+                if (transitions.action[state] == kActionComment)
+                {
+                    AdvanceTo(FindNewline(p, end));
+                    SkipWhitespace();
+                    token.offset = static_cast<std::uint32_t>(Position());
+                    start = p = input_ + token.offset;
+                    continue;
+                }
+            }
+            break;
+        }
+
+#if defined(__GNUC__)
+        //Labels as values: one indirect jump straight to the action
+        static void* const actions[] = {
+            &&start_action, &&identifier_action, &&integer_action, &&float_action,
+            &&comment_action, &&string_action, &&symbol_action, &&incomplete_action,
+        };
+        goto *actions[transitions.action[state]];
+#else
+        switch (transitions.action[state])
+        {
+        case kActionStart: goto start_action;
+        case kActionIdentifier: goto identifier_action;
+        case kActionInteger: goto integer_action;
+        case kActionFloat: goto float_action;
+        case kActionComment: goto comment_action;
+        case kActionString: goto string_action;
+        case kActionSymbol: goto symbol_action;
+        case kActionIncomplete: goto incomplete_action;
+        }
+#endif
+
+    start_action:
+        if (p == end)
+        {
+            token.type = TokenType::Eof;
+        }
+        else
+        {
+            Warn<Policy>(DiagCode::UnexpectedChar, token.offset, *p);
+            token.type = TokenType::Illegal;
+            ++p;
+        }
+        goto done;
+
+    identifier_action:
+        token.value = std::string_view(start, p - start);
+        token.type = Token::LookupIdentifier(token.value);
+        if (token.type == TokenType::Identifier)
+        {
+            token.symbol = interner_->Intern(token.value);
+        }
+        goto done;
+
+    integer_action:
+    {
+        //Wraps on overflow exactly like ScanNumber, so even Illegal tokens match
+        const std::uint64_t max = std::numeric_limits<std::uint64_t>::max();
+        std::uint64_t value = 0;
+        bool fits = true;
+        for (const char* q = start; q < p; ++q)
+        {
+            if (*q != '_')
+            {
+                std::uint64_t digit = static_cast<std::uint64_t>(*q - '0');
+                fits = fits && value <= (max - digit) / 10;
+                value = value * 10 + digit;
+            }
+        }
+        token.type = fits ? TokenType::Integer : TokenType::Illegal;
+        token.literal.integer = value;
+        if (!fits)
+        {
+            Report(DiagCode::NumberOutOfRange, token.offset);
+        }
+        goto done;
+    }
+
+    float_action:
+        token.value = std::string_view(start, p - start);
+        token.type = TokenType::Float;
+        if (!DecodeLiteral(TokenType::Float, token.value, token.literal))
+        {
+            Report(DiagCode::NumberOutOfRange, token.offset);
+            token.type = TokenType::Illegal;
+        }
+        goto done;
+
+    comment_action:
+        //Up to the newline, which is left for the whitespace skip
+        p = FindNewline(p, end);
+        token.type = TokenType::Comment;
+        goto done;
+
+    string_action:
+        //The scanner has not moved yet and still sits on the opening quote
+        ScanString(token);
+        return;
+
+    symbol_action:
+        token.type = transitions.accept[state];
+        goto done;
+
+    incomplete_action:
+        //Same as ScanSymbol: blame the byte after the prefix and take one byte
+        Warn<Policy>(DiagCode::UnexpectedChar, token.offset, p < end ? *p : EOF_CHAR);
+        token.type = TokenType::Illegal;
+        p = start + 1;
+        goto done;
+
+    done:
+        token.value = std::string_view(start, p - start);
+        AdvanceTo(p);
+    }
+
+    template void Scanner::ScanTable<ScanPolicy<true, true>>(Token& token);
+    template void Scanner::ScanTable<ScanPolicy<true, false>>(Token& token);
+    template void Scanner::ScanTable<ScanPolicy<false, true>>(Token& token);
+    template void Scanner::ScanTable<ScanPolicy<false, false>>(Token& token);
+}
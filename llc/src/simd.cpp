@@ -0,0 +1,250 @@
+// llc is a compiler for a toy language
+// Copyright (C) 2014  Logan Romantic
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+#include <cstdlib>
+#include <cstring>
+#include "chars.h"
+#include "simd.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define LLC_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+namespace llc
+{
+    typedef const char* (*RunKernel)(const char*, const char*);
+
+    struct SimdKernels
+    {
+        const char* name;
+        RunKernel skip_whitespace;
+        RunKernel skip_identifier;
+        RunKernel find_newline;
+    };
+
+    const char* hSkipClassScalar(const char* p, const char* end, CharClass cls)
+    {
+        while (p < end && HasClass(*p, cls))
+        {
+            ++p;
+        }
+        return p;
+    }
+
+    const char* hSkipWhitespaceScalar(const char* p, const char* end)
+    {
+        return hSkipClassScalar(p, end, kWhitespace);
+    }
+
+    const char* hSkipIdentifierScalar(const char* p, const char* end)
+    {
+        return hSkipClassScalar(p, end, kIdentContinue);
+    }
+
+    const char* hFindNewlineScalar(const char* p, const char* end)
+    {
+        const void* nl = std::memchr(p, '\n', end - p);
+        return nl ? static_cast<const char*>(nl) : end;
+    }
+
+#ifdef LLC_SIMD_X86
+    // The byte-class tests below use unsigned range checks:
+    // (b - lo) <= (hi - lo) holds exactly when lo <= b <= hi.
+
+    __attribute__((target("sse2")))
+    inline __m128i hInRange128(__m128i b, char lo, char hi)
+    {
+        __m128i x = _mm_sub_epi8(b, _mm_set1_epi8(lo));
+        __m128i limit = _mm_set1_epi8(static_cast<char>(hi - lo));
+        return _mm_cmpeq_epi8(_mm_min_epu8(x, limit), x);
+    }
+
+    __attribute__((target("sse2")))
+    inline __m128i hWhitespace128(__m128i b)
+    {
+        return _mm_or_si128(_mm_cmpeq_epi8(b, _mm_set1_epi8(' ')), hInRange128(b, '\t', '\r'));
+    }
+
+    __attribute__((target("sse2")))
+    inline __m128i hIdentifier128(__m128i b)
+    {
+        __m128i lower = _mm_or_si128(b, _mm_set1_epi8(0x20));
+        __m128i ident = _mm_or_si128(hInRange128(lower, 'a', 'z'), hInRange128(b, '0', '9'));
+        return _mm_or_si128(ident, _mm_cmpeq_epi8(b, _mm_set1_epi8('_')));
+    }
+
+    __attribute__((target("sse2")))
+    const char* hSkipWhitespaceSse2(const char* p, const char* end)
+    {
+        for (; end - p >= 16; p += 16)
+        {
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            unsigned stop = ~_mm_movemask_epi8(hWhitespace128(b)) & 0xFFFFu;
+            if (stop)
+            {
+                return p + __builtin_ctz(stop);
+            }
+        }
+        return hSkipWhitespaceScalar(p, end);
+    }
+
+    __attribute__((target("sse2")))
+    const char* hSkipIdentifierSse2(const char* p, const char* end)
+    {
+        for (; end - p >= 16; p += 16)
+        {
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            unsigned stop = ~_mm_movemask_epi8(hIdentifier128(b)) & 0xFFFFu;
+            if (stop)
+            {
+                return p + __builtin_ctz(stop);
+            }
+        }
+        return hSkipIdentifierScalar(p, end);
+    }
+
+    __attribute__((target("sse2")))
+    const char* hFindNewlineSse2(const char* p, const char* end)
+    {
+        const __m128i nl = _mm_set1_epi8('\n');
+        for (; end - p >= 16; p += 16)
+        {
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            unsigned hit = _mm_movemask_epi8(_mm_cmpeq_epi8(b, nl));
+            if (hit)
+            {
+                return p + __builtin_ctz(hit);
+            }
+        }
+        return hFindNewlineScalar(p, end);
+    }
+
+    __attribute__((target("avx2")))
+    inline __m256i hInRange256(__m256i b, char lo, char hi)
+    {
+        __m256i x = _mm256_sub_epi8(b, _mm256_set1_epi8(lo));
+        __m256i limit = _mm256_set1_epi8(static_cast<char>(hi - lo));
+        return _mm256_cmpeq_epi8(_mm256_min_epu8(x, limit), x);
+    }
+
+    __attribute__((target("avx2")))
+    const char* hSkipWhitespaceAvx2(const char* p, const char* end)
+    {
+        const __m256i space = _mm256_set1_epi8(' ');
+        for (; end - p >= 32; p += 32)
+        {
+            __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            __m256i ws = _mm256_or_si256(_mm256_cmpeq_epi8(b, space), hInRange256(b, '\t', '\r'));
+            unsigned stop = ~static_cast<unsigned>(_mm256_movemask_epi8(ws));
+            if (stop)
+            {
+                return p + __builtin_ctz(stop);
+            }
+        }
+        return hSkipWhitespaceSse2(p, end);
+    }
+
+    __attribute__((target("avx2")))
+    const char* hSkipIdentifierAvx2(const char* p, const char* end)
+    {
+        const __m256i case_bit = _mm256_set1_epi8(0x20);
+        const __m256i underscore = _mm256_set1_epi8('_');
+        for (; end - p >= 32; p += 32)
+        {
+            __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            __m256i lower = _mm256_or_si256(b, case_bit);
+            __m256i ident = _mm256_or_si256(hInRange256(lower, 'a', 'z'), hInRange256(b, '0', '9'));
+            ident = _mm256_or_si256(ident, _mm256_cmpeq_epi8(b, underscore));
+            unsigned stop = ~static_cast<unsigned>(_mm256_movemask_epi8(ident));
+            if (stop)
+            {
+                return p + __builtin_ctz(stop);
+            }
+        }
+        return hSkipIdentifierSse2(p, end);
+    }
+
+    __attribute__((target("avx2")))
+    const char* hFindNewlineAvx2(const char* p, const char* end)
+    {
+        const __m256i nl = _mm256_set1_epi8('\n');
+        for (; end - p >= 32; p += 32)
+        {
+            __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            unsigned hit = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(b, nl)));
+            if (hit)
+            {
+                return p + __builtin_ctz(hit);
+            }
+        }
+        return hFindNewlineSse2(p, end);
+    }
+#endif
+
+    SimdKernels hSelectKernels()
+    {
+        const SimdKernels scalar = {
+            "scalar", hSkipWhitespaceScalar, hSkipIdentifierScalar, hFindNewlineScalar
+        };
+
+        const char* forced = std::getenv("LLC_SIMD");
+        if (forced != nullptr && std::strcmp(forced, "scalar") == 0)
+        {
+            return scalar;
+        }
+
+#ifdef LLC_SIMD_X86
+        __builtin_cpu_init();
+        bool allow_avx2 = forced == nullptr || std::strcmp(forced, "sse2") != 0;
+        if (allow_avx2 && __builtin_cpu_supports("avx2"))
+        {
+            return { "avx2", hSkipWhitespaceAvx2, hSkipIdentifierAvx2, hFindNewlineAvx2 };
+        }
+        if (__builtin_cpu_supports("sse2"))
+        {
+            return { "sse2", hSkipWhitespaceSse2, hSkipIdentifierSse2, hFindNewlineSse2 };
+        }
+#endif
+        return scalar;
+    }
+
+    const SimdKernels& hKernels()
+    {
+        static const SimdKernels kernels = hSelectKernels();
+        return kernels;
+    }
+
+    const char* SkipWhitespaceRun(const char* p, const char* end)
+    {
+        return hKernels().skip_whitespace(p, end);
+    }
+
+    const char* SkipIdentifierRun(const char* p, const char* end)
+    {
+        return hKernels().skip_identifier(p, end);
+    }
+
+    const char* FindNewline(const char* p, const char* end)
+    {
+        return hKernels().find_newline(p, end);
+    }
+
+    const char* SimdTarget()
+    {
+        return hKernels().name;
+    }
+}
@@ -0,0 +1,143 @@
+// llc is a compiler for a toy language
+// Copyright (C) 2014  Logan Romantic
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "source.h"
+
+namespace llc
+{
+    const std::size_t kReadChunk = 64 * 1024;
+
+    SourceBuffer::SourceBuffer()
+        : data_(nullptr), size_(0), map_(nullptr)
+    {}
+
+    SourceBuffer::~SourceBuffer()
+    {
+        Close();
+    }
+
+    bool SourceBuffer::Open(const std::string& filepath)
+    {
+        Close();
+
+        if (filepath == "-")
+        {
+            return ReadAll(STDIN_FILENO);
+        }
+
+        int fd = ::open(filepath.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            error_ = "Cannot open '" + filepath + "': " + std::strerror(errno);
+            return false;
+        }
+
+        struct stat st;
+        bool ok;
+        if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode))
+        {
+            //Fall back to reading if the mapping is refused (e.g. some network filesystems)
+            ok = Map(fd, static_cast<std::size_t>(st.st_size)) || ReadAll(fd);
+        }
+        else
+        {
+            ok = ReadAll(fd);
+        }
+        ::close(fd);
+
+        if (!ok)
+        {
+            error_ = "Cannot read '" + filepath + "': " + error_;
+        }
+        return ok;
+    }
+
+    void SourceBuffer::Close()
+    {
+        if (map_ != nullptr)
+        {
+            ::munmap(map_, size_);
+            map_ = nullptr;
+        }
+        //Keeps the capacity, so reopening stdin-like input does not reallocate
+        buffer_.clear();
+        data_ = nullptr;
+        size_ = 0;
+        error_.clear();
+    }
+
+    bool SourceBuffer::Map(int fd, std::size_t size)
+    {
+        if (size == 0)
+        {
+            //mmap rejects empty ranges, an empty file is simply an empty buffer
+            return true;
+        }
+
+        void* addr = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED)
+        {
+            return false;
+        }
+        ::madvise(addr, size, MADV_SEQUENTIAL);
+
+        map_ = addr;
+        data_ = static_cast<const char*>(addr);
+        size_ = size;
+        return true;
+    }
+
+    bool SourceBuffer::ReadAll(int fd)
+    {
+        std::size_t used = 0;
+        for (;;)
+        {
+            if (buffer_.size() - used < kReadChunk)
+            {
+                buffer_.resize(used + kReadChunk);
+            }
+
+            ssize_t n = ::read(fd, &buffer_[used], buffer_.size() - used);
+            if (n < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                error_ = std::strerror(errno);
+                std::vector<char>().swap(buffer_);
+                return false;
+            }
+            if (n == 0)
+            {
+                break;
+            }
+            used += static_cast<std::size_t>(n);
+        }
+
+        buffer_.resize(used);
+        data_ = buffer_.data();
+        size_ = used;
+        return true;
+    }
+}
@@ -0,0 +1,171 @@
+// llc is a compiler for a toy language
+// Copyright (C) 2014  Logan Romantic
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+#include "stats.h"
+
+#ifdef LLC_STATS
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <sys/resource.h>
+
+namespace llc
+{
+    std::atomic<std::uint64_t> hAllocations(0);
+    std::atomic<std::uint64_t> hAllocatedBytes(0);
+
+    std::mutex hTotalMutex;
+    ScanStats hTotal = {};
+
+    void hAddStats(ScanStats& into, const ScanStats& from)
+    {
+        std::uint64_t* to = reinterpret_cast<std::uint64_t*>(&into);
+        const std::uint64_t* add = reinterpret_cast<const std::uint64_t*>(&from);
+        for (std::size_t i = 0; i < sizeof(ScanStats) / sizeof(std::uint64_t); ++i)
+        {
+            to[i] += add[i];
+        }
+    }
+
+    struct StatsSlot
+    {
+        StatsSlot() : stats() {}
+        ~StatsSlot()
+        {
+            std::lock_guard<std::mutex> lock(hTotalMutex);
+            hAddStats(hTotal, stats);
+        }
+
+        ScanStats stats;
+    };
+
+    thread_local StatsSlot hLocal;
+
+    ScanStats& LocalStats()
+    {
+        return hLocal.stats;
+    }
+
+    std::uint64_t StatClock()
+    {
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    void hJsonString(std::string& out, std::string_view text)
+    {
+        out += '"';
+        for (char c : text)
+        {
+            if (c == '"' || c == '\\')
+            {
+                out += '\\';
+            }
+            out += c;
+        }
+        out += '"';
+    }
+
+    void hJsonField(std::string& out, std::string_view name, std::uint64_t value, bool last = false)
+    {
+        hJsonString(out, name);
+        out += ':';
+        out += std::to_string(value);
+        out += last ? "" : ",";
+    }
+
+    std::string StatsJson()
+    {
+        static const char* routines[kStatRoutineCount] = {
+            "SkipWhitespace", "ScanComment", "ScanIdentifier", "ScanNumber", "ScanString", "ScanSymbol", "ScanIllegal", "ScanTable"
+        };
+        static const char* phases[kStatPhaseCount] = { "read", "scan", "parse", "dump" };
+
+        ScanStats stats;
+        {
+            std::lock_guard<std::mutex> lock(hTotalMutex);
+            stats = hTotal;
+        }
+        hAddStats(stats, hLocal.stats);
+
+        struct rusage usage;
+        ::getrusage(RUSAGE_SELF, &usage);
+
+        std::string out = "{";
+        hJsonField(out, "bytes", stats.bytes);
+        hJsonField(out, "tokens", stats.tokens);
+
+        out += "\"token_types\":{";
+        for (std::size_t i = 0; i < kTokenTypeCount; ++i)
+        {
+            hJsonField(out, Token::Name(static_cast<TokenType>(i)), stats.token_types[i], i + 1 == kTokenTypeCount);
+        }
+        out += "},\"routines\":{";
+        for (std::size_t i = 0; i < kStatRoutineCount; ++i)
+        {
+            hJsonString(out, routines[i]);
+            out += ":{";
+            hJsonField(out, "calls", stats.routine_calls[i]);
+            hJsonField(out, "ns", stats.routine_ns[i], true);
+            out += i + 1 == kStatRoutineCount ? "}" : "},";
+        }
+        out += "},\"phases_ns\":{";
+        for (std::size_t i = 0; i < kStatPhaseCount; ++i)
+        {
+            hJsonField(out, phases[i], stats.phase_ns[i], i + 1 == kStatPhaseCount);
+        }
+        out += "},\"keywords\":{";
+        hJsonField(out, "lookups", stats.keyword_lookups);
+        hJsonField(out, "hits", stats.keyword_hits);
+        double rate = stats.keyword_lookups ? static_cast<double>(stats.keyword_hits) / stats.keyword_lookups : 0.0;
+        out += "\"hit_rate\":" + std::to_string(rate);
+        out += "},\"allocations\":{";
+        hJsonField(out, "count", hAllocations.load(std::memory_order_relaxed));
+        hJsonField(out, "bytes", hAllocatedBytes.load(std::memory_order_relaxed), true);
+        out += "},";
+        hJsonField(out, "peak_rss_kb", static_cast<std::uint64_t>(usage.ru_maxrss), true);
+        out += "}";
+        return out;
+    }
+}
+
+//Every allocation in the process is counted, not just the scanner's
+void* operator new(std::size_t size)
+{
+    llc::hAllocations.fetch_add(1, std::memory_order_relaxed);
+    llc::hAllocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    void* p = std::malloc(size ? size : 1);
+    if (p == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+#endif
@@ -0,0 +1,112 @@
+// llc is a compiler for a toy language
+// Copyright (C) 2014  Logan Romantic
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+#include <algorithm>
+#include <cstring>
+#include "simd.h"
+#include "stream_scanner.h"
+
+namespace llc
+{
+    StreamScanner::StreamScanner(std::istream& in, std::size_t window)
+        : in_(in), window_(std::max<std::size_t>(window, 16)), end_(0), base_(0),
+          eof_(false), has_errors_(false), max_diagnostics_(0), located_(0), line_(1), line_start_(0)
+    {
+        scanner_.AttachBuffer(window_.data(), 0);
+    }
+
+    Token StreamScanner::Scan()
+    {
+        for (;;)
+        {
+            //The window scanner only knows the diagnostics since the last refill
+            std::size_t reported = scanner_.diagnostics_.size();
+            std::size_t interned = scanner_.interner().size();
+            if (max_diagnostics_ != 0)
+            {
+                scanner_.set_max_diagnostics(max_diagnostics_ - diagnostics_.size() + reported);
+            }
+            Token token = scanner_.Scan();
+
+            //Complete once the scanner stopped on a byte it actually read
+            if (eof_ || scanner_.Position() < end_)
+            {
+                Span<const Diagnostic> records = scanner_.diagnostics_.records();
+                for (std::size_t i = reported; i < records.size(); ++i)
+                {
+                    std::uint32_t offset = records[i].offset + base_;
+                    diagnostics_.Report(records[i].code, offset, records[i].arg);
+                    diagnostic_coords_.push_back(Locate(offset));
+                }
+                has_errors_ = has_errors_ || diagnostics_.error_count() > 0;
+                token.offset += base_;
+                return token;
+            }
+
+            //A cut-off identifier or string must not keep a symbol
+            scanner_.diagnostics_.Truncate(reported);
+            scanner_.interner().Truncate(interned);
+            Refill(token.offset);
+        }
+    }
+
+    Coord StreamScanner::Locate(std::uint32_t offset)
+    {
+        const char* from = window_.data() + (located_ - base_);
+        const char* to = window_.data() + (offset - base_);
+        for (const char* nl = FindNewline(from, to); nl != to; nl = FindNewline(nl + 1, to))
+        {
+            line_ += 1;
+            line_start_ = base_ + static_cast<std::uint32_t>(nl + 1 - window_.data());
+        }
+        located_ = offset;
+        return Coord(line_, static_cast<int>(offset - line_start_) + 1);
+    }
+
+    //Drops the window up to keep, then fills it up again
+    void StreamScanner::Refill(std::size_t keep)
+    {
+        //Line tracking must not fall behind the new window start
+        if (located_ < base_ + keep)
+        {
+            Locate(base_ + static_cast<std::uint32_t>(keep));
+        }
+
+        std::memmove(window_.data(), window_.data() + keep, end_ - keep);
+        end_ -= keep;
+        base_ += static_cast<std::uint32_t>(keep);
+
+        if (end_ == window_.size())
+        {
+            window_.resize(window_.size() * 2);
+        }
+
+        in_.read(window_.data() + end_, static_cast<std::streamsize>(window_.size() - end_));
+        end_ += static_cast<std::size_t>(in_.gcount());
+        if (!in_)
+        {
+            //A short read only happens at the end of the stream or on failure
+            eof_ = true;
+            if (in_.bad())
+            {
+                has_errors_ = true;
+                errors_.push_back(std::make_shared<Error>("Read failed", Coord()));
+            }
+        }
+
+        scanner_.AttachBuffer(window_.data(), end_);
+    }
+}
@@ -14,14 +14,21 @@
 // You should have received a copy of the GNU General Public License
 // along with this program; if not, write to the Free Software
 // Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
-#include <map>
 #include <string>
 #include <sstream>
+#include "stats.h"
 #include "token.h"
+#include "token_names.h"
 
 namespace llc 
 {
-    std::map<std::string, TokenType> keywords = {
+    struct Keyword
+    {
+        std::string_view name;
+        TokenType type;
+    };
+
+    constexpr Keyword keywords[] = {
         {"program", TokenType::Program},
         {"is", TokenType::Is},
         {"begin", TokenType::Begin},
@@ -44,56 +51,55 @@ namespace llc
         {"false", TokenType::FalseKey},
     };
 
-    std::map<TokenType, std::string> token_names = {
-        { TokenType::Illegal, "ILLEGAL" },
-        { TokenType::Eof, "EOF" },
-        { TokenType::Comment, "COMMENT" },
-        { TokenType::Identifier, "IDENT" },
-        { TokenType::Integer, "INT" },
-        { TokenType::Float, "FLOAT" },
-        { TokenType::Bool, "BOOL" },
-        { TokenType::String, "STRING" },
-        { TokenType::SemiColon, ";" },
-        { TokenType::Comma, "," },
-        { TokenType::Lparen, "(" },
-        { TokenType::Rparen, ")" },
-        { TokenType::Lbracket, "[" },
-        { TokenType::Rbracket, "]" },
-        { TokenType::Assign, ":=" },
-        { TokenType::Or, "|" },
-        { TokenType::And, "&" },
-        { TokenType::Add, "+" },
-        { TokenType::Sub, "-" },
-        { TokenType::Mul, "*" },
-        { TokenType::Div, "/" },
-        { TokenType::Less, "<" },
-        { TokenType::Greater, ">" },
-        { TokenType::LessEql, "<=" },
-        { TokenType::GreaterEql, ">=" },
-        { TokenType::Eql, "==" },
-        { TokenType::Neq, "!=" },
-        { TokenType::Program, "program" },
-        { TokenType::Is, "is" },
-        { TokenType::Begin, "begin" },
-        { TokenType::End, "end" },
-        { TokenType::Global, "global" },
-        { TokenType::Procedure, "procedure" },
-        { TokenType::In, "in" },
-        { TokenType::Out, "out" },
-        { TokenType::IntegerType, "integer" },
-        { TokenType::FloatType, "float" },
-        { TokenType::BoolType, "bool" },
-        { TokenType::StringType, "string" },
-        { TokenType::If, "if" },
-        { TokenType::Then, "then" },
-        { TokenType::Else, "else" },
-        { TokenType::For, "for" },
-        { TokenType::Return, "return" },
-        { TokenType::Not, "not" },
-        { TokenType::TrueKey, "true" },
-        { TokenType::FalseKey, "false" },
+    // Perfect hash over the keywords above: length plus the first two
+    // characters picks a unique slot, so a lookup is one probe and at most
+    // one string compare. The static_assert below rejects a keyword list
+    // that collides; retune the coefficients if it ever fires.
+    constexpr std::size_t kKeywordSlots = 64;
+    constexpr std::size_t kMinKeywordLength = 2;
+    constexpr std::size_t kMaxKeywordLength = 9;
+
+    constexpr std::size_t hKeywordHash(std::string_view value)
+    {
+        return (value.size()
+            + static_cast<unsigned char>(value[0])
+            + 4 * static_cast<unsigned char>(value[1])) & (kKeywordSlots - 1);
+    }
+
+    struct KeywordTable
+    {
+        Keyword slots[kKeywordSlots];
+        bool perfect;
     };
 
+    constexpr KeywordTable hBuildKeywordTable()
+    {
+        KeywordTable table = {};
+        table.perfect = true;
+        for (auto& slot : table.slots)
+        {
+            slot = {"", TokenType::Identifier};
+        }
+        for (const auto& keyword : keywords)
+        {
+            if (keyword.name.size() < kMinKeywordLength || keyword.name.size() > kMaxKeywordLength)
+            {
+                table.perfect = false;
+                continue;
+            }
+            Keyword& slot = table.slots[hKeywordHash(keyword.name)];
+            if (!slot.name.empty())
+            {
+                table.perfect = false;
+            }
+            slot = keyword;
+        }
+        return table;
+    }
+
+    constexpr KeywordTable keyword_table = hBuildKeywordTable();
+    static_assert(keyword_table.perfect, "keyword hash collides or a keyword is out of the length range");
+
     std::string Coord::String()
     {
         std::ostringstream ss;
@@ -101,26 +107,60 @@ namespace llc
         return ss.str();
     }
 
-    Token::Token() : type(TokenType::Illegal), value("")
+    Token::Token() : type(TokenType::Illegal), value(), offset(0), symbol(0), literal()
     {}
 
-    Token::Token(TokenType token_type_, std::string value_, Coord coord_)
-        : type(token_type_), value(value_), coord(coord_) 
+    Token::Token(TokenType token_type_, std::string_view value_, std::uint32_t offset_)
+        : type(token_type_), value(value_), offset(offset_), symbol(0), literal()
     {}
 
     Token::~Token() 
     {}
 
-    TokenType Token::LookupIdentifier(const std::string& value)
+    TokenType Token::LookupIdentifier(std::string_view value)
     {
-        if (keywords.find(value) != keywords.end()) {
-            return keywords[value];
+        LLC_STATS_ADD(keyword_lookups, 1);
+        if (value.size() < kMinKeywordLength || value.size() > kMaxKeywordLength)
+        {
+            return TokenType::Identifier;
+        }
+
+        const Keyword& slot = keyword_table.slots[hKeywordHash(value)];
+        if (slot.name == value)
+        {
+            LLC_STATS_ADD(keyword_hits, 1);
+            return slot.type;
         }
         return TokenType::Identifier;
     }
 
-    std::string Token::GetName() const
+    std::string_view Token::Name(TokenType type)
+    {
+        return token_names[static_cast<std::size_t>(type)].name;
+    }
+
+    std::string_view Token::GetName() const
     {
-        return token_names[type];
+        return Name(type);
+    }
+
+    std::string Token::Materialize() const
+    {
+        if (type != TokenType::Integer && type != TokenType::Float)
+        {
+            return std::string(value);
+        }
+
+        //Digit separators are only spelling
+        std::string digits;
+        digits.reserve(value.size());
+        for (char c : value)
+        {
+            if (c != '_')
+            {
+                digits.push_back(c);
+            }
+        }
+        return digits;
     }
 }
\ No newline at end of file
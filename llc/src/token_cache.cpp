@@ -0,0 +1,305 @@
+// llc is a compiler for a toy language
+// Copyright (C) 2014  Logan Romantic
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "scanner.h"
+#include "source.h"
+#include "token_cache.h"
+
+namespace llc
+{
+    struct CacheHeader
+    {
+        char magic[4];
+        std::uint32_t format_version;
+        std::uint32_t scanner_version;
+        std::uint32_t token_types;
+        std::uint64_t token_names;
+        std::uint64_t source_hash;
+        std::uint64_t source_size;
+        std::uint32_t token_count;
+        std::uint32_t literal_count;
+        std::uint32_t diagnostic_count;
+        std::uint32_t symbol_count;
+        std::uint64_t name_bytes;
+    };
+
+    static_assert(sizeof(CacheHeader) == 64, "CacheHeader layout changed");
+
+    const char kCacheMagic[4] = { 'L', 'L', 'C', 'K' };
+    const std::size_t kDiagnosticBytes = 6;
+
+    //Multiply-xorshift over 8-byte words, fast enough to be dwarfed by the read
+    std::uint64_t hHashBytes(const char* data, std::size_t size)
+    {
+        const std::uint64_t k = 0x9E3779B97F4A7C15ull;
+        std::uint64_t hash = size * k;
+
+        std::size_t i = 0;
+        for (; i + 8 <= size; i += 8)
+        {
+            std::uint64_t word;
+            std::memcpy(&word, data + i, 8);
+            hash = (hash ^ word) * k;
+            hash ^= hash >> 29;
+        }
+        for (; i < size; ++i)
+        {
+            hash = (hash ^ static_cast<unsigned char>(data[i])) * k;
+        }
+
+        hash ^= hash >> 32;
+        hash *= k;
+        return hash ^ (hash >> 29);
+    }
+
+    //Changes whenever a TokenType is added, removed, renamed or reordered
+    std::uint64_t hTokenNames()
+    {
+        static const std::uint64_t names = []()
+        {
+            std::string all;
+            for (std::size_t i = 0; i < kTokenTypeCount; ++i)
+            {
+                all += Token::Name(static_cast<TokenType>(i));
+                all += '\n';
+            }
+            return hHashBytes(all.data(), all.size());
+        }();
+        return names;
+    }
+
+    TokenCache::TokenCache(std::string directory)
+        : directory_(std::move(directory))
+    {}
+
+    std::string TokenCache::PathFor(std::uint64_t hash) const
+    {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.tok", static_cast<unsigned long long>(hash));
+        return directory_ + "/" + name;
+    }
+
+    bool TokenCache::Load(const char* data, std::size_t size, TokenStream& tokens,
+        Diagnostics& diagnostics, Interner& interner) const
+    {
+        std::uint64_t hash = hHashBytes(data, size);
+        SourceBuffer file;
+        if (!file.Open(PathFor(hash)) || file.size() < sizeof(CacheHeader))
+        {
+            return false;
+        }
+
+        CacheHeader header;
+        std::memcpy(&header, file.data(), sizeof(header));
+        if (std::memcmp(header.magic, kCacheMagic, 4) != 0
+            || header.format_version != kFormatVersion
+            || header.scanner_version != Scanner::kVersion
+            || header.token_types != kTokenTypeCount
+            || header.token_names != hTokenNames()
+            || header.source_hash != hash
+            || header.source_size != size)
+        {
+            return false;
+        }
+
+        std::size_t n = header.token_count;
+        std::size_t expected = sizeof(CacheHeader) + n * (3 * 4 + 1) + header.literal_count * 8ull
+            + header.diagnostic_count * kDiagnosticBytes + header.symbol_count * 4ull + header.name_bytes;
+        if (n == 0 || file.size() != expected)
+        {
+            return false;
+        }
+
+        const char* p = file.data() + sizeof(CacheHeader);
+        tokens.Clear();
+        tokens.Resize(n);
+        std::memcpy(tokens.offsets_.data(), p, n * 4);
+        p += n * 4;
+        std::memcpy(tokens.lengths_.data(), p, n * 4);
+        p += n * 4;
+        std::memcpy(tokens.aux_.data(), p, n * 4);
+        p += n * 4;
+
+        tokens.literals_.Resize(header.literal_count);
+        for (std::uint32_t i = 0; i < header.literal_count; ++i, p += 8)
+        {
+            LiteralValue value;
+            std::memcpy(&value, p, 8);
+            tokens.literals_.Set(i, value);
+        }
+
+        std::vector<Diagnostic> records(header.diagnostic_count);
+        for (Diagnostic& d : records)
+        {
+            std::memcpy(&d.offset, p, 4);
+            d.code = static_cast<DiagCode>(p[4]);
+            d.arg = p[5];
+            p += kDiagnosticBytes;
+        }
+
+        std::memcpy(tokens.types_.data(), p, n);
+        p += n;
+
+        //A damaged file must not hand out offsets outside the source
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            TokenType type = tokens.types_[i];
+            if (static_cast<std::size_t>(type) >= kTokenTypeCount
+                || tokens.offsets_[i] > size || tokens.value_offset(i) + std::uint64_t(tokens.lengths_[i]) > size)
+            {
+                return false;
+            }
+            std::uint32_t limit = IsSymbolToken(type) ? header.symbol_count
+                : IsNumberLiteral(type) && tokens.aux_[i] != PackedToken::kNoAux ? header.literal_count
+                : Interner::kNoSymbol;
+            if (tokens.aux_[i] >= limit)
+            {
+                return false;
+            }
+        }
+        for (const Diagnostic& d : records)
+        {
+            if (d.code > DiagCode::TooManyDiagnostics)
+            {
+                return false;
+            }
+        }
+
+        std::vector<std::uint32_t> lengths(header.symbol_count);
+        std::memcpy(lengths.data(), p, lengths.size() * 4);
+        p += lengths.size() * 4;
+        std::uint64_t name_bytes = 0;
+        for (std::uint32_t length : lengths)
+        {
+            name_bytes += length;
+        }
+        if (name_bytes != header.name_bytes)
+        {
+            return false;
+        }
+
+        std::vector<std::uint32_t> symbols(header.symbol_count);
+        for (std::size_t i = 0; i < symbols.size(); ++i)
+        {
+            symbols[i] = interner.Intern(std::string_view(p, lengths[i]));
+            p += lengths[i];
+        }
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            if (IsSymbolToken(tokens.types_[i]))
+            {
+                tokens.aux_[i] = symbols[tokens.aux_[i]];
+            }
+        }
+
+        diagnostics.Append(Span<const Diagnostic>(records.data(), records.size()));
+        return true;
+    }
+
+    bool TokenCache::Store(const char* data, std::size_t size, const TokenStream& tokens,
+        const Diagnostics& diagnostics, const Interner& interner) const
+    {
+        std::size_t n = tokens.size();
+
+        //Renumber the symbols this stream uses from zero
+        std::vector<std::uint32_t> aux = tokens.aux_;
+        std::vector<std::uint32_t> numbering(interner.size(), Interner::kNoSymbol);
+        std::vector<std::uint32_t> used;
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            if (IsSymbolToken(tokens.types_[i]))
+            {
+                std::uint32_t& number = numbering[aux[i]];
+                if (number == Interner::kNoSymbol)
+                {
+                    number = static_cast<std::uint32_t>(used.size());
+                    used.push_back(aux[i]);
+                }
+                aux[i] = number;
+            }
+        }
+
+        CacheHeader header = {};
+        std::memcpy(header.magic, kCacheMagic, 4);
+        header.format_version = kFormatVersion;
+        header.scanner_version = Scanner::kVersion;
+        header.token_types = kTokenTypeCount;
+        header.token_names = hTokenNames();
+        header.source_hash = hHashBytes(data, size);
+        header.source_size = size;
+        header.token_count = static_cast<std::uint32_t>(n);
+        header.literal_count = static_cast<std::uint32_t>(tokens.literals_.size());
+        header.diagnostic_count = static_cast<std::uint32_t>(diagnostics.size());
+        header.symbol_count = static_cast<std::uint32_t>(used.size());
+        for (std::uint32_t symbol : used)
+        {
+            header.name_bytes += interner.Name(symbol).size();
+        }
+
+        std::string out;
+        out.reserve(sizeof(header) + n * 13 + header.literal_count * 8 + header.name_bytes + used.size() * 4);
+        out.append(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.append(reinterpret_cast<const char*>(tokens.offsets_.data()), n * 4);
+        out.append(reinterpret_cast<const char*>(tokens.lengths_.data()), n * 4);
+        out.append(reinterpret_cast<const char*>(aux.data()), n * 4);
+        for (std::uint32_t i = 0; i < header.literal_count; ++i)
+        {
+            LiteralValue value = tokens.literals_[i];
+            out.append(reinterpret_cast<const char*>(&value), 8);
+        }
+        for (const Diagnostic& d : diagnostics.records())
+        {
+            out.append(reinterpret_cast<const char*>(&d.offset), 4);
+            out.push_back(static_cast<char>(d.code));
+            out.push_back(d.arg);
+        }
+        out.append(reinterpret_cast<const char*>(tokens.types_.data()), n);
+        for (std::uint32_t symbol : used)
+        {
+            std::uint32_t length = static_cast<std::uint32_t>(interner.Name(symbol).size());
+            out.append(reinterpret_cast<const char*>(&length), 4);
+        }
+        for (std::uint32_t symbol : used)
+        {
+            out.append(interner.Name(symbol));
+        }
+
+        ::mkdir(directory_.c_str(), 0777);
+
+        static std::atomic<unsigned> sequence(0);
+        std::string path = PathFor(header.source_hash);
+        std::string temp = path + "." + std::to_string(::getpid()) + "." + std::to_string(sequence++);
+
+        std::FILE* f = std::fopen(temp.c_str(), "wb");
+        if (f == nullptr)
+        {
+            return false;
+        }
+        bool ok = std::fwrite(out.data(), 1, out.size(), f) == out.size();
+        ok = std::fclose(f) == 0 && ok;
+        if (!ok || std::rename(temp.c_str(), path.c_str()) != 0)
+        {
+            std::remove(temp.c_str());
+            return false;
+        }
+        return true;
+    }
+}
@@ -0,0 +1,129 @@
+// llc is a compiler for a toy language
+// Copyright (C) 2014  Logan Romantic
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+#include "token_pipeline.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define LLC_PAUSE() __builtin_ia32_pause()
+#else
+#define LLC_PAUSE() ((void)0)
+#endif
+
+namespace llc
+{
+    //Spin briefly, then give the core away while the other side catches up
+    void hBackoff(unsigned& spins)
+    {
+        if (spins < 64)
+        {
+            spins += 1;
+            LLC_PAUSE();
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    TokenPipeline::TokenPipeline(Scanner& scanner, bool comments)
+        : scanner_(scanner), queue_(kBatches), current_(nullptr), index_(0), done_(false)
+    {
+        if (comments)
+        {
+            producer_ = std::thread(&TokenPipeline::Produce<DefaultScanPolicy>, this);
+        }
+        else
+        {
+            producer_ = std::thread(&TokenPipeline::Produce<CodeScanPolicy>, this);
+        }
+    }
+
+    TokenPipeline::~TokenPipeline()
+    {
+        Finish();
+    }
+
+    template <typename Policy>
+    void TokenPipeline::Produce()
+    {
+        for (;;)
+        {
+            Batch* batch;
+            unsigned spins = 0;
+            while ((batch = queue_.TryAcquire()) == nullptr)
+            {
+                hBackoff(spins);
+            }
+
+            bool eof = false;
+            batch->count = 0;
+            while (batch->count < kBatchTokens && !eof)
+            {
+                Token& token = batch->tokens[batch->count++];
+                token = scanner_.ScanWith<Policy>();
+                eof = token.type == TokenType::Eof;
+            }
+            queue_.Publish();
+
+            if (eof)
+            {
+                return;
+            }
+        }
+    }
+
+    Token TokenPipeline::Next()
+    {
+        if (done_)
+        {
+            return eof_;
+        }
+
+        if (current_ == nullptr || index_ == current_->count)
+        {
+            if (current_ != nullptr)
+            {
+                queue_.Release();
+            }
+            unsigned spins = 0;
+            while ((current_ = queue_.TryFront()) == nullptr)
+            {
+                hBackoff(spins);
+            }
+            index_ = 0;
+        }
+
+        const Token& token = current_->tokens[index_++];
+        if (token.type == TokenType::Eof)
+        {
+            done_ = true;
+            eof_ = token;
+        }
+        return token;
+    }
+
+    void TokenPipeline::Finish()
+    {
+        while (!done_)
+        {
+            Next();
+        }
+        if (producer_.joinable())
+        {
+            producer_.join();
+        }
+    }
+}
@@ -0,0 +1,229 @@
+// llc is a compiler for a toy language
+// Copyright (C) 2014  Logan Romantic
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+#include <algorithm>
+#include "token_stream.h"
+
+namespace llc
+{
+    //Garbage left by splices is only reclaimed past this many entries
+    const std::size_t kMinCompactLiterals = 4096;
+
+    bool hHasLiteral(TokenType type, std::uint32_t aux)
+    {
+        return IsNumberLiteral(type) && aux != PackedToken::kNoAux;
+    }
+
+    TokenStream::TokenStream()
+        : input_(nullptr), dead_literals_(0)
+    {}
+
+    TokenStream::TokenStream(const char* input)
+        : input_(input), dead_literals_(0)
+    {}
+
+    void TokenStream::Reserve(std::size_t count)
+    {
+        types_.reserve(count);
+        offsets_.reserve(count);
+        lengths_.reserve(count);
+        aux_.reserve(count);
+    }
+
+    void TokenStream::Resize(std::size_t count)
+    {
+        types_.resize(count);
+        offsets_.resize(count);
+        lengths_.resize(count);
+        aux_.resize(count);
+    }
+
+    void TokenStream::Clear()
+    {
+        types_.clear();
+        offsets_.clear();
+        lengths_.clear();
+        aux_.clear();
+        literals_.Clear();
+        dead_literals_ = 0;
+    }
+
+    void TokenStream::Push(const Token& token)
+    {
+        std::uint32_t aux = 0;
+        if (IsNumberLiteral(token.type))
+        {
+            aux = literals_.Add(token.literal);
+        }
+        else if (IsSymbolToken(token.type))
+        {
+            aux = token.symbol;
+        }
+
+        types_.push_back(token.type);
+        offsets_.push_back(token.offset);
+        lengths_.push_back(static_cast<std::uint32_t>(token.value.size()));
+        aux_.push_back(aux);
+    }
+
+    //Copies tokens [first, first + count) of other over [at, at + count) of
+    //this stream, their literals to this table from literal_at on and their
+    //symbols through symbol_map
+    void TokenStream::CopyFrom(const TokenStream& other, std::size_t first, std::size_t count, std::size_t at,
+        std::uint32_t literal_at, const std::vector<std::uint32_t>& symbol_map)
+    {
+        std::copy_n(other.types_.begin() + first, count, types_.begin() + at);
+        std::copy_n(other.offsets_.begin() + first, count, offsets_.begin() + at);
+        std::copy_n(other.lengths_.begin() + first, count, lengths_.begin() + at);
+        std::copy_n(other.aux_.begin() + first, count, aux_.begin() + at);
+
+        for (std::size_t i = at; i < at + count; ++i)
+        {
+            if (hHasLiteral(types_[i], aux_[i]))
+            {
+                std::uint32_t from = aux_[i];
+                aux_[i] = PackedToken::kNoAux;
+                if (literal_at < literals_.size())
+                {
+                    literals_.Set(literal_at, other.literals_[from]);
+                    aux_[i] = literal_at++;
+                }
+            }
+            else if (IsSymbolToken(types_[i]))
+            {
+                aux_[i] = symbol_map[aux_[i]];
+            }
+        }
+    }
+
+    //Replaces tokens [first, last) with the first count tokens of replacement
+    //and moves every token after them by shift bytes
+    void TokenStream::Splice(std::size_t first, std::size_t last, const TokenStream& replacement, std::size_t count, std::int64_t shift)
+    {
+        for (std::size_t i = first; i < last; ++i)
+        {
+            dead_literals_ += hHasLiteral(types_[i], aux_[i]) ? 1 : 0;
+        }
+
+        types_.erase(types_.begin() + first, types_.begin() + last);
+        offsets_.erase(offsets_.begin() + first, offsets_.begin() + last);
+        lengths_.erase(lengths_.begin() + first, lengths_.begin() + last);
+        aux_.erase(aux_.begin() + first, aux_.begin() + last);
+
+        types_.insert(types_.begin() + first, replacement.types_.begin(), replacement.types_.begin() + count);
+        offsets_.insert(offsets_.begin() + first, replacement.offsets_.begin(), replacement.offsets_.begin() + count);
+        lengths_.insert(lengths_.begin() + first, replacement.lengths_.begin(), replacement.lengths_.begin() + count);
+        aux_.insert(aux_.begin() + first, replacement.aux_.begin(), replacement.aux_.begin() + count);
+
+        for (std::size_t i = first; i < first + count; ++i)
+        {
+            if (hHasLiteral(types_[i], aux_[i]))
+            {
+                aux_[i] = literals_.Add(replacement.literals_[aux_[i]]);
+            }
+        }
+        for (std::size_t i = first + count; i < offsets_.size(); ++i)
+        {
+            offsets_[i] = static_cast<std::uint32_t>(offsets_[i] + shift);
+        }
+
+        if (literals_.size() > kMinCompactLiterals && dead_literals_ > literals_.size() / 2)
+        {
+            CompactLiterals();
+        }
+    }
+
+    //Rebuilds the literal table without the entries of spliced-out tokens
+    void TokenStream::CompactLiterals()
+    {
+        LiteralTable literals;
+        for (std::size_t i = 0; i < types_.size(); ++i)
+        {
+            if (hHasLiteral(types_[i], aux_[i]))
+            {
+                aux_[i] = literals.Add(literals_[aux_[i]]);
+            }
+        }
+        literals_ = std::move(literals);
+        dead_literals_ = 0;
+    }
+
+    std::uint32_t TokenStream::value_offset(std::size_t i) const
+    {
+        return offsets_[i] + ValueSkip(types_[i]);
+    }
+
+    std::string_view TokenStream::value(std::size_t i) const
+    {
+        return std::string_view(input_ + value_offset(i), lengths_[i]);
+    }
+
+    Token TokenStream::token(std::size_t i) const
+    {
+        Token token(type(i), value(i), offset(i));
+        if (IsSymbolToken(types_[i]))
+        {
+            token.symbol = aux_[i];
+        }
+        else if (IsNumberLiteral(types_[i]))
+        {
+            Literal(i, token.literal);
+        }
+        return token;
+    }
+
+    PackedToken TokenStream::packed(std::size_t i) const
+    {
+        return PackedToken(types_[i], offsets_[i], lengths_[i], std::min(aux_[i], PackedToken::kNoAux));
+    }
+
+    bool TokenStream::Literal(std::size_t i, LiteralValue& out) const
+    {
+        if (hHasLiteral(types_[i], aux_[i]))
+        {
+            out = literals_[aux_[i]];
+            return true;
+        }
+        return DecodeLiteral(types_[i], value(i), out);
+    }
+
+    std::uint32_t TokenStream::LiteralsBefore(std::size_t i) const
+    {
+        while (i > 0)
+        {
+            i -= 1;
+            if (hHasLiteral(types_[i], aux_[i]))
+            {
+                return aux_[i] + 1;
+            }
+        }
+        return 0;
+    }
+
+    //Symbols are numbered by first appearance, so this is one past the largest ID
+    std::uint32_t TokenStream::SymbolsBefore(std::size_t i) const
+    {
+        std::uint32_t count = 0;
+        for (std::size_t j = 0; j < i; ++j)
+        {
+            if (IsSymbolToken(types_[j]))
+            {
+                count = std::max(count, aux_[j] + 1);
+            }
+        }
+        return count;
+    }
+}
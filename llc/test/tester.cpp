@@ -0,0 +1,1072 @@
+// llc is a compiler for a toy language
+// Copyright (C) 2014  Logan Romantic
+
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <dirent.h>
+#include <unistd.h>
+#include "corpus.h"
+#include "dump.h"
+#include "incremental.h"
+#include "parser.h"
+#include "scanner.h"
+#include "stream_scanner.h"
+#include "token_cache.h"
+
+// Checks of the scanner, the parser and the paths around them. Most are
+// equivalence checks: a parallel, streaming, incremental or table-driven
+// scan must give the tokens, symbol IDs and diagnostics of a plain
+// sequential scan of the same input. The rest pin exact output for small
+// hand-written inputs. Generated inputs come from fixed seeds.
+//
+//   tester [test...]
+//
+// runs every test, or only the named ones, and exits non-zero on failure.
+// Build with make tester SANITIZE=thread to run the threaded ones under
+// ThreadSanitizer.
+
+struct TestCase
+{
+    const char* name;
+    void (*run)();
+};
+
+int failures = 0;
+
+void Check(bool ok, const std::string& what)
+{
+    if (!ok)
+    {
+        failures += 1;
+        std::cerr << "  FAIL " << what << std::endl;
+    }
+}
+
+// A corpus with count random bytes overwritten, for diagnostics and
+// malformed tokens.
+std::string Mutate(std::string text, std::size_t count, std::mt19937& rng)
+{
+    if (text.empty())
+    {
+        return text;
+    }
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        text[rng() % text.size()] = static_cast<char>(rng());
+    }
+    return text;
+}
+
+std::uint64_t LiteralBits(const llc::TokenStream& tokens, std::size_t i)
+{
+    llc::LiteralValue value;
+    std::uint64_t bits = 0;
+    if (tokens.Literal(i, value))
+    {
+        std::memcpy(&bits, &value, sizeof(bits));
+    }
+    return bits;
+}
+
+// Describes the first difference between two token streams, or returns an
+// empty string when they match. Without exact_symbols only the names behind
+// symbol IDs have to match.
+std::string CompareTokens(const llc::TokenStream& a, const llc::Interner& a_symbols,
+    const llc::TokenStream& b, const llc::Interner& b_symbols, bool exact_symbols = true)
+{
+    if (a.size() != b.size())
+    {
+        return "token count " + std::to_string(a.size()) + " vs " + std::to_string(b.size());
+    }
+
+    for (std::size_t i = 0; i < a.size(); ++i)
+    {
+        llc::TokenType type = a.type(i);
+        bool same = type == b.type(i) && a.offset(i) == b.offset(i) && a.length(i) == b.length(i);
+        if (same && (type == llc::TokenType::Identifier || type == llc::TokenType::String))
+        {
+            same = (!exact_symbols || a.aux(i) == b.aux(i)) && a_symbols.Name(a.aux(i)) == b_symbols.Name(b.aux(i));
+        }
+        if (same && llc::IsNumberLiteral(type))
+        {
+            same = LiteralBits(a, i) == LiteralBits(b, i);
+        }
+        if (!same)
+        {
+            return "token " + std::to_string(i) + " at offset " + std::to_string(a.offset(i));
+        }
+    }
+
+    if (exact_symbols && a_symbols.size() != b_symbols.size())
+    {
+        return "symbol count " + std::to_string(a_symbols.size()) + " vs " + std::to_string(b_symbols.size());
+    }
+    return "";
+}
+
+std::string CompareDiagnostics(const llc::Diagnostics& a, const llc::Diagnostics& b)
+{
+    if (a.size() != b.size())
+    {
+        return "diagnostic count " + std::to_string(a.size()) + " vs " + std::to_string(b.size());
+    }
+    for (std::size_t i = 0; i < a.size(); ++i)
+    {
+        const llc::Diagnostic& x = a.records()[i];
+        const llc::Diagnostic& y = b.records()[i];
+        if (x.offset != y.offset || x.code != y.code || x.arg != y.arg)
+        {
+            return "diagnostic " + std::to_string(i) + " at offset " + std::to_string(x.offset);
+        }
+    }
+    return "";
+}
+
+void CheckSame(const std::string& what, const std::string& difference)
+{
+    Check(difference.empty(), what + ": " + difference);
+}
+
+//Chunks are at least 1 MiB, so inputs need a few of them
+void TestParallel()
+{
+    std::mt19937 rng(8);
+    for (llc::ScanEngine engine : { llc::ScanEngine::Handwritten, llc::ScanEngine::Dfa })
+    {
+        for (std::size_t mix = 0; mix < llc::kCorpusMixCount; ++mix)
+        {
+            std::string text = llc::GenerateCorpus(llc::kCorpusMixes[mix], 5 << 20, static_cast<std::uint32_t>(mix + 1));
+            if (mix % 2 == 1)
+            {
+                text = Mutate(text, 2000, rng);
+            }
+            std::string what = std::string(llc::kCorpusMixes[mix].name) + (engine == llc::ScanEngine::Dfa ? " dfa" : "");
+
+            llc::Scanner sequential;
+            sequential.set_engine(engine);
+            sequential.AttachBuffer(text.data(), text.size());
+            llc::TokenStream expected = sequential.ScanAll();
+
+            llc::Scanner parallel;
+            parallel.set_engine(engine);
+            parallel.AttachBuffer(text.data(), text.size());
+            llc::TokenStream tokens = parallel.ScanAllParallel(4);
+
+            CheckSame(what, CompareTokens(tokens, parallel.interner(), expected, sequential.interner()));
+            CheckSame(what, CompareDiagnostics(parallel.diagnostics(), sequential.diagnostics()));
+            Check(parallel.has_errors() == sequential.has_errors(), what + ": has_errors");
+        }
+    }
+}
+
+//Symbol IDs stay stable across edits, so only their names are compared
+void TestIncremental()
+{
+    const char pieces[] = "abc xyz 12 3.5 _ \"s\" \" // ; := = ( ) \n\n \t $ ~";
+    std::mt19937 rng(12);
+    int before = failures;
+
+    for (std::size_t mix = 0; mix < llc::kCorpusMixCount; ++mix)
+    {
+        llc::IncrementalLexer lexer;
+        lexer.Reset(llc::GenerateCorpus(llc::kCorpusMixes[mix], 4096, static_cast<std::uint32_t>(mix + 1)));
+
+        for (int round = 0; round < 500; ++round)
+        {
+            llc::TextEdit edit;
+            std::size_t size = lexer.text().size();
+            edit.offset = static_cast<std::uint32_t>(rng() % (size + 1));
+            edit.removed = static_cast<std::uint32_t>(std::min<std::size_t>(rng() % 12, size - edit.offset));
+            for (std::size_t n = rng() % 10; n > 0; --n)
+            {
+                edit.inserted += pieces[rng() % (sizeof(pieces) - 1)];
+            }
+            Check(lexer.Apply(edit), "edit rejected");
+
+            llc::Scanner full;
+            full.AttachBuffer(lexer.text().data(), lexer.text().size());
+            llc::TokenStream expected = full.ScanAll();
+
+            std::string what = std::string(llc::kCorpusMixes[mix].name) + " edit " + std::to_string(round);
+            CheckSame(what, CompareTokens(lexer.tokens(), lexer.interner(), expected, full.interner(), false));
+            CheckSame(what, CompareDiagnostics(lexer.diagnostics(), full.diagnostics()));
+            if (failures != before)
+            {
+                //Every later edit would fail as well
+                return;
+            }
+        }
+    }
+}
+
+//Small windows split many tokens, the last ones grow the window
+void TestStream()
+{
+    std::mt19937 rng(13);
+    for (std::size_t mix = 0; mix < llc::kCorpusMixCount; ++mix)
+    {
+        std::string text = Mutate(llc::GenerateCorpus(llc::kCorpusMixes[mix], 64 << 10, static_cast<std::uint32_t>(mix + 1)), 200, rng);
+
+        llc::Scanner whole;
+        whole.AttachBuffer(text.data(), text.size());
+        llc::TokenStream expected = whole.ScanAll();
+
+        for (std::size_t window : { 16, 17, 31, 64, 1000 })
+        {
+            std::string what = std::string(llc::kCorpusMixes[mix].name) + " window " + std::to_string(window);
+            std::istringstream in(text);
+            llc::StreamScanner stream(in, window);
+
+            std::size_t i = 0;
+            for (llc::Token token = stream.Scan();; token = stream.Scan(), ++i)
+            {
+                bool same = i < expected.size() && token.type == expected.type(i)
+                    && token.offset == expected.offset(i) && token.value == expected.value(i);
+                if (same && llc::IsNumberLiteral(token.type))
+                {
+                    std::uint64_t bits;
+                    std::memcpy(&bits, &token.literal, sizeof(bits));
+                    same = bits == LiteralBits(expected, i);
+                }
+                if (!same)
+                {
+                    Check(false, what + ": token " + std::to_string(i) + " at offset " + std::to_string(token.offset));
+                    break;
+                }
+                if (token.type == llc::TokenType::Eof)
+                {
+                    break;
+                }
+            }
+
+            CheckSame(what, CompareDiagnostics(stream.diagnostics(), whole.diagnostics()));
+            for (std::size_t d = 0; d < stream.diagnostic_coords().size() && d < whole.diagnostics().size(); ++d)
+            {
+                llc::Coord coord = whole.Locate(whole.diagnostics().records()[d].offset);
+                llc::Coord got = stream.diagnostic_coords()[d];
+                Check(got.line == coord.line && got.column == coord.column, what + ": coord of diagnostic " + std::to_string(d));
+            }
+        }
+    }
+}
+
+//Tokens cut off by the window end are scanned twice but interned once
+void TestStreamSymbols()
+{
+    std::vector<std::string> texts = {
+        "aaaaaaaaaaaaa " + std::string(25, 'b') + " " + std::string(17, 'c') + " aaaaaaaaaaaaa",
+        "\"" + std::string(40, 's') + "\" x \"" + std::string(40, 's') + "\" x",
+    };
+    for (std::size_t mix = 0; mix < llc::kCorpusMixCount; ++mix)
+    {
+        texts.push_back(llc::GenerateCorpus(llc::kCorpusMixes[mix], 16 << 10, static_cast<std::uint32_t>(mix + 1)));
+    }
+
+    for (const std::string& text : texts)
+    {
+        llc::Scanner whole;
+        whole.AttachBuffer(text.data(), text.size());
+        llc::TokenStream expected = whole.ScanAll();
+
+        for (std::size_t window = 16; window <= 64; window += 3)
+        {
+            std::string what = "window " + std::to_string(window) + " at " + text.substr(0, 16);
+            std::istringstream in(text);
+            llc::StreamScanner stream(in, window);
+
+            std::size_t i = 0;
+            for (llc::Token token = stream.Scan(); token.type != llc::TokenType::Eof; token = stream.Scan(), ++i)
+            {
+                if (token.type == llc::TokenType::Identifier || token.type == llc::TokenType::String)
+                {
+                    Check(token.symbol == expected.aux(i), what + ": symbol of token " + std::to_string(i));
+                }
+            }
+
+            Check(stream.interner().size() == whole.interner().size(), what + ": symbol count "
+                + std::to_string(stream.interner().size()) + " vs " + std::to_string(whole.interner().size()));
+            for (std::uint32_t id = 0; id < stream.interner().size() && id < whole.interner().size(); ++id)
+            {
+                Check(stream.interner().Name(id) == whole.interner().Name(id), what + ": name of symbol " + std::to_string(id));
+            }
+        }
+    }
+}
+
+void CheckEnginesAgree(const std::string& what, const std::string& text, std::size_t max_diagnostics = 0)
+{
+    llc::Scanner hand;
+    hand.set_max_diagnostics(max_diagnostics);
+    hand.AttachBuffer(text.data(), text.size());
+    llc::TokenStream expected = hand.ScanAll();
+
+    llc::Scanner dfa;
+    dfa.set_engine(llc::ScanEngine::Dfa);
+    dfa.set_max_diagnostics(max_diagnostics);
+    dfa.AttachBuffer(text.data(), text.size());
+    llc::TokenStream tokens = dfa.ScanAll();
+
+    CheckSame(what, CompareTokens(tokens, dfa.interner(), expected, hand.interner()));
+    CheckSame(what, CompareDiagnostics(dfa.diagnostics(), hand.diagnostics()));
+}
+
+//Half the soups are any bytes, half are drawn from bytes that start or end
+//tokens; some stop early at a diagnostic limit
+void TestDfa()
+{
+    const char alphabet[] = "az_09.\"/:=!<>|&+-*;,()[] \t\n\r$";
+    std::mt19937 rng(23);
+
+    for (int soup = 0; soup < 600; ++soup)
+    {
+        std::string text(rng() % 4096, '\0');
+        for (char& c : text)
+        {
+            c = soup % 2 == 0 ? static_cast<char>(rng()) : alphabet[rng() % (sizeof(alphabet) - 1)];
+        }
+        CheckEnginesAgree("soup " + std::to_string(soup), text, soup % 3 == 0 ? 5 : 0);
+    }
+
+    for (std::size_t mix = 0; mix < llc::kCorpusMixCount; ++mix)
+    {
+        CheckEnginesAgree(llc::kCorpusMixes[mix].name, llc::GenerateCorpus(llc::kCorpusMixes[mix], 1 << 20, static_cast<std::uint32_t>(mix + 1)));
+    }
+}
+
+//Each thread reuses one scanner for every input, in a different order
+void TestReset()
+{
+    const unsigned kThreads = 4;
+    std::mt19937 rng(25);
+
+    std::vector<std::string> texts;
+    for (std::size_t mix = 0; mix < llc::kCorpusMixCount; ++mix)
+    {
+        std::string text = llc::GenerateCorpus(llc::kCorpusMixes[mix], 16 << 10, static_cast<std::uint32_t>(mix + 1));
+        texts.push_back(mix % 2 == 0 ? text : Mutate(text, 50, rng));
+    }
+    texts.push_back("");
+
+    std::vector<std::unique_ptr<llc::Scanner>> fresh;
+    std::vector<llc::TokenStream> expected;
+    for (const std::string& text : texts)
+    {
+        fresh.emplace_back(new llc::Scanner);
+        fresh.back()->AttachBuffer(text.data(), text.size());
+        expected.push_back(fresh.back()->ScanAll());
+    }
+
+    std::vector<std::string> differences(kThreads);
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < kThreads; ++t)
+    {
+        threads.emplace_back([&, t]()
+        {
+            llc::Scanner scanner;
+            for (std::size_t round = 0; round < 4 * texts.size() && differences[t].empty(); ++round)
+            {
+                std::size_t i = (round * (t + 1) + t) % texts.size();
+                scanner.Reset(texts[i].data(), texts[i].size());
+                llc::TokenStream tokens = scanner.ScanAll();
+
+                differences[t] = CompareTokens(tokens, scanner.interner(), expected[i], fresh[i]->interner());
+                if (differences[t].empty())
+                {
+                    differences[t] = CompareDiagnostics(scanner.diagnostics(), fresh[i]->diagnostics());
+                }
+            }
+        });
+    }
+
+    for (unsigned t = 0; t < kThreads; ++t)
+    {
+        threads[t].join();
+        CheckSame("thread " + std::to_string(t), differences[t]);
+    }
+}
+
+// Scans text with the given policy and checks the result is the default
+// scan minus comments and warnings where the policy drops them.
+template <typename Policy>
+void CheckPolicy(const std::string& what, const std::string& text, llc::ScanEngine engine,
+    const llc::TokenStream& expected, const llc::Diagnostics& expected_diagnostics)
+{
+    llc::Scanner scanner;
+    scanner.set_engine(engine);
+    scanner.AttachBuffer(text.data(), text.size());
+
+    std::size_t i = 0;
+    for (;;)
+    {
+        llc::Token token = scanner.ScanWith<Policy>();
+        while (!Policy::kComments && i < expected.size() && expected.type(i) == llc::TokenType::Comment)
+        {
+            i += 1;
+        }
+
+        bool same = i < expected.size() && token.type == expected.type(i)
+            && token.offset == expected.offset(i) && token.value == expected.value(i);
+        if (same && (token.type == llc::TokenType::Identifier || token.type == llc::TokenType::String))
+        {
+            same = token.symbol == expected.aux(i);
+        }
+        if (!same)
+        {
+            Check(false, what + ": token " + std::to_string(i) + " at offset " + std::to_string(token.offset));
+            return;
+        }
+        if (token.type == llc::TokenType::Eof)
+        {
+            break;
+        }
+        i += 1;
+    }
+
+    llc::Diagnostics kept;
+    for (const llc::Diagnostic& d : expected_diagnostics.records())
+    {
+        if (Policy::kWarnings || llc::Diagnostics::SeverityOf(d.code) != llc::Severity::Warning)
+        {
+            kept.Report(d.code, d.offset, d.arg);
+        }
+    }
+    CheckSame(what, CompareDiagnostics(scanner.diagnostics(), kept));
+}
+
+void TestPolicies()
+{
+    std::mt19937 rng(24);
+    for (std::size_t mix = 0; mix < llc::kCorpusMixCount; ++mix)
+    {
+        std::string text = Mutate(llc::GenerateCorpus(llc::kCorpusMixes[mix], 256 << 10, static_cast<std::uint32_t>(mix + 1)), 500, rng);
+
+        llc::Scanner scanner;
+        scanner.AttachBuffer(text.data(), text.size());
+        llc::TokenStream expected = scanner.ScanAll();
+
+        for (llc::ScanEngine engine : { llc::ScanEngine::Handwritten, llc::ScanEngine::Dfa })
+        {
+            std::string what = std::string(llc::kCorpusMixes[mix].name) + (engine == llc::ScanEngine::Dfa ? " dfa" : "");
+            CheckPolicy<llc::ScanPolicy<true, true>>(what, text, engine, expected, scanner.diagnostics());
+            CheckPolicy<llc::ScanPolicy<true, false>>(what + " no warnings", text, engine, expected, scanner.diagnostics());
+            CheckPolicy<llc::ScanPolicy<false, true>>(what + " no comments", text, engine, expected, scanner.diagnostics());
+            CheckPolicy<llc::ScanPolicy<false, false>>(what + " neither", text, engine, expected, scanner.diagnostics());
+        }
+    }
+}
+
+std::uint32_t ReadU32(const std::string& bytes, std::size_t at)
+{
+    std::uint32_t value = 0;
+    for (std::size_t i = 0; i < 4 && at + i < bytes.size(); ++i)
+    {
+        value |= static_cast<std::uint32_t>(static_cast<unsigned char>(bytes[at + i])) << (8 * i);
+    }
+    return value;
+}
+
+//Walks the binary dump of an unreadable file followed by a good one
+void TestBinaryDump()
+{
+    std::string text = llc::GenerateCorpus(llc::kCorpusMixes[0], 4096);
+    llc::Scanner scanner;
+    scanner.AttachBuffer(text.data(), text.size());
+    llc::TokenStream tokens = scanner.ScanAll();
+
+    llc::TokenDumper dumper(llc::DumpFormat::Binary);
+    dumper.BeginFile("missing");
+    dumper.DumpUnreadable();
+    dumper.BeginFile("good");
+    dumper.DumpTokens(tokens);
+    dumper.DumpDiagnostics(scanner);
+    const std::string& out = dumper.buffer();
+
+    std::vector<std::uint32_t> token_counts;
+    std::vector<std::uint32_t> diagnostic_counts;
+    std::size_t at = 0;
+    while (at < out.size() && out.compare(at, 4, "LLCT") == 0)
+    {
+        at += 5;
+        at += 4 + ReadU32(out, at);
+        token_counts.push_back(ReadU32(out, at));
+        at += 4 + 9 * static_cast<std::size_t>(token_counts.back());
+        diagnostic_counts.push_back(ReadU32(out, at));
+        at += 4;
+        for (std::uint32_t d = 0; d < diagnostic_counts.back(); ++d)
+        {
+            at += 16 + ReadU32(out, at + 12);
+        }
+    }
+
+    Check(at == out.size(), "trailing bytes at " + std::to_string(at));
+    Check(token_counts.size() == 2, "file count " + std::to_string(token_counts.size()));
+    if (token_counts.size() == 2)
+    {
+        Check(token_counts[0] == 0 && diagnostic_counts[0] == 0, "unreadable file has counts");
+        Check(token_counts[1] == tokens.size() - 1, "token count");
+        Check(diagnostic_counts[1] == scanner.diagnostics().size(), "diagnostic count");
+    }
+}
+
+// "NAME value|" for every token of text up to Eof, then "message@offset|"
+// for every diagnostic, on both engines; differences between them are
+// reported as failures of what.
+std::string DescribeScan(const std::string& what, const std::string& text, std::size_t max_diagnostics = 0)
+{
+    std::string results[2];
+    for (llc::ScanEngine engine : { llc::ScanEngine::Handwritten, llc::ScanEngine::Dfa })
+    {
+        llc::Scanner scanner;
+        scanner.set_engine(engine);
+        scanner.set_max_diagnostics(max_diagnostics);
+        scanner.AttachBuffer(text.data(), text.size());
+
+        std::string& out = results[engine == llc::ScanEngine::Dfa];
+        for (llc::Token token = scanner.Scan();; token = scanner.Scan())
+        {
+            out += std::string(llc::Token::Name(token.type)) + " " + std::string(token.value) + "|";
+            if (token.type == llc::TokenType::Eof)
+            {
+                break;
+            }
+        }
+        for (const llc::Diagnostic& d : scanner.diagnostics().records())
+        {
+            llc::Diagnostics::Format(d, out);
+            out += "@" + std::to_string(d.offset) + "|";
+        }
+    }
+    Check(results[0] == results[1], what + ": engines differ");
+    return results[0];
+}
+
+void CheckScan(const std::string& what, const std::string& text, const std::string& expected, std::size_t max_diagnostics = 0)
+{
+    std::string got = DescribeScan(what, text, max_diagnostics);
+    Check(got == expected, what + ":\n    got      " + got + "\n    expected " + expected);
+}
+
+//An unterminated string ends at the end of its line, a malformed one at
+//its closing quote; either way scanning resumes right after
+void TestStringRecovery()
+{
+    CheckScan("unterminated", "\"abc\nx",
+        "ILLEGAL \"abc|IDENT x|EOF |Unterminated string@0|");
+    CheckScan("unterminated at end", "y \"tail",
+        "IDENT y|ILLEGAL \"tail|EOF |Unterminated string@2|");
+    CheckScan("malformed", "\"ab$c\" y",
+        "ILLEGAL \"ab$c\"|IDENT y|EOF |Character '$' is not allowed in string@0|");
+    CheckScan("malformed twice", "\"a$b$\" y",
+        "ILLEGAL \"a$b$\"|IDENT y|EOF |Character '$' is not allowed in string@0|");
+    CheckScan("malformed and unterminated", "\"a$b\nz \"ok\"",
+        "ILLEGAL \"a$b|IDENT z|STRING ok|EOF |Character '$' is not allowed in string@0|Unterminated string@0|");
+}
+
+//With a limit of N the scanner stops after the token raising the Nth
+//diagnostic, adds one saying so and ends with Eof
+void TestDiagnosticLimit()
+{
+    CheckScan("limit", "$ $ $ $ $ $",
+        "ILLEGAL $|ILLEGAL $|ILLEGAL $|EOF |Unexpected value '$'@0|Unexpected value '$'@2|Unexpected value '$'@4|"
+        "Too many diagnostics, scanning stopped@4|", 3);
+    CheckScan("limit at the end", "$ $ $",
+        "ILLEGAL $|ILLEGAL $|ILLEGAL $|EOF |Unexpected value '$'@0|Unexpected value '$'@2|Unexpected value '$'@4|", 3);
+    CheckScan("limit of one", "x \"a\ny $",
+        "IDENT x|ILLEGAL \"a|EOF |Unterminated string@2|Too many diagnostics, scanning stopped@2|", 1);
+    CheckScan("no limit", "$ $ $ $",
+        "ILLEGAL $|ILLEGAL $|ILLEGAL $|ILLEGAL $|EOF |Unexpected value '$'@0|Unexpected value '$'@2|"
+        "Unexpected value '$'@4|Unexpected value '$'@6|");
+
+    llc::Scanner scanner;
+    scanner.set_max_diagnostics(2);
+    std::string text = "$ $ $ $";
+    scanner.AttachBuffer(text.data(), text.size());
+    llc::TokenStream tokens = scanner.ScanAll();
+    Check(tokens.size() == 3 && tokens.type(2) == llc::TokenType::Eof && scanner.diagnostics().size() == 3, "ScanAll with a limit");
+}
+
+//Values are pinned as bit patterns, so a bug both engines share still shows
+void TestNumberValues()
+{
+    struct Case
+    {
+        std::string text;
+        llc::TokenType type;
+        std::uint64_t bits;
+    };
+    const Case cases[] = {
+        { "0", llc::TokenType::Integer, 0 },
+        { "1_000", llc::TokenType::Integer, 1000 },
+        { "18446744073709551615", llc::TokenType::Integer, 0xFFFFFFFFFFFFFFFFull },
+        { "18446744073709551616", llc::TokenType::Illegal, 0 },
+        { "99999999999999999999", llc::TokenType::Illegal, 0 },
+        { "2.5", llc::TokenType::Float, 0x4004000000000000ull },
+        { "0.1", llc::TokenType::Float, 0x3FB999999999999Aull },
+        { "1_0.2_5", llc::TokenType::Float, 0x4024800000000000ull },
+        { "3.14159", llc::TokenType::Float, 0x400921F9F01B866Eull },
+        { "1" + std::string(308, '0') + ".0", llc::TokenType::Float, 0x7FE1CCF385EBC8A0ull },
+        { "1" + std::string(400, '0') + ".0", llc::TokenType::Illegal, 0 },
+    };
+
+    for (const Case& c : cases)
+    {
+        std::string name = c.text.substr(0, 24);
+        for (llc::ScanEngine engine : { llc::ScanEngine::Handwritten, llc::ScanEngine::Dfa })
+        {
+            std::string what = name + (engine == llc::ScanEngine::Dfa ? " dfa" : "");
+            llc::Scanner scanner;
+            scanner.set_engine(engine);
+            scanner.AttachBuffer(c.text.data(), c.text.size());
+            llc::TokenStream tokens = scanner.ScanAll();
+
+            Check(tokens.size() == 2 && tokens.type(0) == c.type && tokens.length(0) == c.text.size(), what + ": token");
+            bool illegal = c.type == llc::TokenType::Illegal;
+            Check(scanner.diagnostics().size() == (illegal ? 1u : 0u)
+                && (!illegal || scanner.diagnostics().records()[0].code == llc::DiagCode::NumberOutOfRange), what + ": diagnostics");
+            if (!illegal)
+            {
+                Check(LiteralBits(tokens, 0) == c.bits, what + ": value");
+            }
+        }
+
+        llc::LiteralValue value;
+        llc::TokenType type = c.text.find('.') == std::string::npos ? llc::TokenType::Integer : llc::TokenType::Float;
+        bool decoded = llc::DecodeLiteral(type, c.text, value);
+        std::uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        Check(decoded == (c.type != llc::TokenType::Illegal) && (!decoded || bits == c.bits), name + ": DecodeLiteral");
+    }
+}
+
+std::string ReadFile(const std::string& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    std::stringstream bytes;
+    bytes << in.rdbuf();
+    return bytes.str();
+}
+
+void WriteFile(const std::string& path, const std::string& bytes)
+{
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+// Paths of the files in a directory, with it removed when done.
+struct TempDirectory
+{
+    TempDirectory()
+    {
+        char name[] = "/tmp/llc-tester-XXXXXX";
+        path = ::mkdtemp(name) ? name : "";
+    }
+
+    ~TempDirectory()
+    {
+        for (const std::string& file : Files())
+        {
+            std::remove(file.c_str());
+        }
+        ::rmdir(path.c_str());
+    }
+
+    std::vector<std::string> Files() const
+    {
+        std::vector<std::string> files;
+        if (DIR* dir = ::opendir(path.c_str()))
+        {
+            while (dirent* entry = ::readdir(dir))
+            {
+                if (entry->d_name[0] != '.')
+                {
+                    files.push_back(path + "/" + entry->d_name);
+                }
+            }
+            ::closedir(dir);
+        }
+        return files;
+    }
+
+    std::string path;
+};
+
+//Loads are checked to fail without touching their outputs
+void CheckCacheRejects(const std::string& what, const llc::TokenCache& cache, const std::string& text)
+{
+    llc::TokenStream tokens(text.data());
+    llc::Diagnostics diagnostics;
+    llc::Interner interner;
+    Check(!cache.Load(text.data(), text.size(), tokens, diagnostics, interner), what + ": loaded");
+    Check(diagnostics.empty() && interner.size() == 0, what + ": outputs changed");
+}
+
+void TestTokenCache()
+{
+    std::mt19937 rng(19);
+    std::string text = Mutate(llc::GenerateCorpus(llc::kCorpusMixes[0], 64 << 10), 100, rng);
+    TempDirectory directory;
+    Check(!directory.path.empty(), "mkdtemp");
+    llc::TokenCache cache(directory.path);
+
+    llc::Scanner scanner;
+    scanner.AttachBuffer(text.data(), text.size());
+    llc::TokenStream expected = scanner.ScanAll();
+    Check(!scanner.diagnostics().empty() && expected.literals().size() != 0 && scanner.interner().size() != 0, "sample covers everything");
+
+    CheckCacheRejects("empty cache", cache, text);
+    Check(cache.Store(text.data(), text.size(), expected, scanner.diagnostics(), scanner.interner()), "store");
+    std::vector<std::string> files = directory.Files();
+    Check(files.size() == 1, std::to_string(files.size()) + " cache files");
+    if (files.size() != 1)
+    {
+        return;
+    }
+
+    {
+        llc::TokenStream tokens(text.data());
+        llc::Diagnostics diagnostics;
+        llc::Interner interner;
+        Check(cache.Load(text.data(), text.size(), tokens, diagnostics, interner), "load");
+        CheckSame("load", CompareTokens(tokens, interner, expected, scanner.interner()));
+        CheckSame("load", CompareDiagnostics(diagnostics, scanner.diagnostics()));
+    }
+    {
+        //Symbols already in the interner get different IDs, but the same names
+        llc::TokenStream tokens(text.data());
+        llc::Diagnostics diagnostics;
+        llc::Interner interner;
+        interner.Intern("already_there");
+        Check(cache.Load(text.data(), text.size(), tokens, diagnostics, interner), "load into used interner");
+        CheckSame("load into used interner", CompareTokens(tokens, interner, expected, scanner.interner(), false));
+    }
+    {
+        llc::Scanner cached;
+        cached.AttachBuffer(text.data(), text.size());
+        llc::TokenStream tokens = cached.ScanAllCached(cache, 1);
+        CheckSame("ScanAllCached", CompareTokens(tokens, cached.interner(), expected, scanner.interner()));
+        CheckSame("ScanAllCached", CompareDiagnostics(cached.diagnostics(), scanner.diagnostics()));
+        Check(cached.has_errors() == scanner.has_errors(), "ScanAllCached: has_errors");
+    }
+
+    std::string changed = text;
+    changed[changed.size() / 2] ^= 1;
+    CheckCacheRejects("other source", cache, changed);
+
+    const std::string good = ReadFile(files[0]);
+    struct Damage
+    {
+        const char* what;
+        std::size_t at;
+        std::size_t size;
+    };
+    //Header fields: magic 0, format 4, scanner 8, token types 12, names 16, hash 24, size 32, counts 40
+    const Damage damages[] = {
+        { "truncated by one byte", 0, good.size() - 1 },
+        { "truncated to half", 0, good.size() / 2 },
+        { "truncated inside the header", 0, 40 },
+        { "flipped magic", 1, good.size() },
+        { "flipped token type count", 12, good.size() },
+        { "flipped source hash", 25, good.size() },
+        { "flipped token count", 40, good.size() },
+    };
+    for (const Damage& damage : damages)
+    {
+        std::string bytes = good.substr(0, damage.size);
+        if (damage.at != 0)
+        {
+            bytes[damage.at] ^= 0x10;
+        }
+        WriteFile(files[0], bytes);
+        CheckCacheRejects(damage.what, cache, text);
+    }
+
+    for (std::size_t at : { 4, 8 })
+    {
+        std::string bytes = good;
+        std::uint32_t version = at == 4 ? llc::TokenCache::kFormatVersion + 1 : llc::Scanner::kVersion + 1;
+        std::memcpy(&bytes[at], &version, 4);
+        WriteFile(files[0], bytes);
+        CheckCacheRejects(at == 4 ? "format version" : "scanner version", cache, text);
+    }
+
+    WriteFile(files[0], good);
+    llc::TokenStream tokens(text.data());
+    llc::Diagnostics diagnostics;
+    llc::Interner interner;
+    Check(cache.Load(text.data(), text.size(), tokens, diagnostics, interner), "load after restoring");
+}
+
+// Parses text into arena; the tree keeps views into text.
+llc::Program* ParseText(const std::string& text, llc::Arena& arena, llc::Diagnostics& diagnostics)
+{
+    llc::Scanner scanner;
+    scanner.AttachBuffer(text.data(), text.size());
+    llc::Parser parser(scanner, arena);
+    llc::Program* program = parser.ParseProgram();
+    diagnostics = parser.diagnostics();
+    return program;
+}
+
+std::size_t CountStmts(const llc::Stmt* stmt)
+{
+    std::size_t count = 0;
+    for (; stmt != nullptr; stmt = stmt->next)
+    {
+        count += 1;
+    }
+    return count;
+}
+
+// "name=value " for every assignment of an integer literal in the list.
+std::string DescribeAssignments(const llc::Stmt* stmt)
+{
+    std::string out;
+    for (; stmt != nullptr; stmt = stmt->next)
+    {
+        if (stmt->kind == llc::StmtKind::Assign && stmt->target != nullptr && stmt->value != nullptr
+            && stmt->value->kind == llc::ExprKind::Integer)
+        {
+            out += std::string(stmt->target->text) + "=" + std::to_string(stmt->value->literal.integer) + " ";
+        }
+    }
+    return out;
+}
+
+const char kValidProgram[] =
+    "program test_program is\n"
+    "    global integer count;\n"
+    "    global float values[10];\n"
+    "    string name;\n"
+    "    procedure add(integer a in, integer b in, integer result out)\n"
+    "        bool flag;\n"
+    "    begin\n"
+    "        result := a + b * -2;\n"
+    "        if (not a < b & b != 0 | flag) then\n"
+    "            flag := true;\n"
+    "        else\n"
+    "            flag := false;\n"
+    "        end if;\n"
+    "    end procedure;\n"
+    "begin\n"
+    "    for (count := 1; count <= 10)\n"
+    "        values[count] := count / 2.5;\n"
+    "        add(count, -count, count);\n"
+    "    end for;\n"
+    "    name := \"hello world\";\n"
+    "    return;\n"
+    "end program\n";
+
+void TestParserValid()
+{
+    std::string text = kValidProgram;
+    llc::Arena arena;
+    llc::Diagnostics diagnostics;
+    llc::Program* program = ParseText(text, arena, diagnostics);
+
+    Check(diagnostics.empty(), std::to_string(diagnostics.size()) + " diagnostics");
+    Check(program->name == "test_program", "program name");
+
+    const llc::Decl* count = program->decls;
+    Check(count != nullptr && count->kind == llc::DeclKind::Variable && count->global
+        && count->type_mark == llc::TokenType::IntegerType && count->name == "count" && count->bound == nullptr, "count");
+    const llc::Decl* values = count ? count->next : nullptr;
+    Check(values != nullptr && values->type_mark == llc::TokenType::FloatType && values->bound != nullptr
+        && values->bound->literal.integer == 10, "values[10]");
+    const llc::Decl* name = values ? values->next : nullptr;
+    Check(name != nullptr && !name->global && name->type_mark == llc::TokenType::StringType, "name");
+
+    const llc::Decl* add = name ? name->next : nullptr;
+    Check(add != nullptr && add->kind == llc::DeclKind::Procedure && add->name == "add" && add->next == nullptr, "add");
+    if (add != nullptr)
+    {
+        const llc::Decl* a = add->params;
+        const llc::Decl* result = a && a->next ? a->next->next : nullptr;
+        Check(a != nullptr && a->mode == llc::ParamMode::In && result != nullptr
+            && result->mode == llc::ParamMode::Out && result->name == "result" && result->next == nullptr, "parameters");
+        Check(add->decls != nullptr && add->decls->name == "flag" && add->decls->next == nullptr, "locals");
+        Check(CountStmts(add->body) == 2, "procedure body");
+
+        //result := a + (b * (-2))
+        const llc::Stmt* assign = add->body;
+        const llc::Expr* sum = assign ? assign->value : nullptr;
+        Check(sum != nullptr && sum->kind == llc::ExprKind::Binary && sum->op == llc::TokenType::Add
+            && sum->left->kind == llc::ExprKind::Name && sum->right->kind == llc::ExprKind::Binary
+            && sum->right->op == llc::TokenType::Mul && sum->right->right->kind == llc::ExprKind::Negate, "precedence");
+
+        const llc::Stmt* branch = assign ? assign->next : nullptr;
+        Check(branch != nullptr && branch->kind == llc::StmtKind::If && CountStmts(branch->body) == 1
+            && CountStmts(branch->else_body) == 1, "if");
+    }
+
+    Check(CountStmts(program->body) == 3, "program body");
+    const llc::Stmt* loop = program->body;
+    Check(loop != nullptr && loop->kind == llc::StmtKind::For && loop->init != nullptr
+        && loop->init->kind == llc::StmtKind::Assign && loop->value != nullptr && CountStmts(loop->body) == 2, "for");
+    if (loop != nullptr && CountStmts(loop->body) == 2)
+    {
+        const llc::Stmt* store = loop->body;
+        Check(store->target != nullptr && store->target->left != nullptr && store->value->op == llc::TokenType::Div, "indexed store");
+        const llc::Stmt* call = store->next;
+        Check(call->kind == llc::StmtKind::Call && call->name == "add" && call->args != nullptr
+            && call->args->next != nullptr && call->args->next->kind == llc::ExprKind::Negate, "call");
+    }
+    const llc::Stmt* last = loop && loop->next ? loop->next->next : nullptr;
+    Check(last != nullptr && last->kind == llc::StmtKind::Return && last->next == nullptr, "return");
+}
+
+//Every error below is reported once, at the marked token, and parsing
+//carries on after the next ';'
+void TestParserRecovery()
+{
+    std::string text =
+        "program p is\n"
+        "    integer x\n"
+        "    float lost;\n"
+        "    integer z;\n"
+        "    procedure q(integer a)\n"
+        "    begin\n"
+        "        a := ;\n"
+        "        a := 1;\n"
+        "    end procedure;\n"
+        "begin\n"
+        "    x := (1 + ;\n"
+        "    z := 2;\n"
+        "    b := 3 4;\n"
+        "    z := 3;\n"
+        "    frob begin;\n"
+        "    z := 4;\n"
+        "end program\n";
+    struct Expected
+    {
+        const char* at;
+        llc::DiagCode code;
+        llc::TokenType arg;
+    };
+    const Expected expected[] = {
+        { "float lost", llc::DiagCode::ExpectedToken, llc::TokenType::SemiColon },
+        { ")\n    begin", llc::DiagCode::ExpectedToken, llc::TokenType::In },
+        { ";\n        a := 1", llc::DiagCode::UnexpectedToken, llc::TokenType::SemiColon },
+        { ";\n    z := 2", llc::DiagCode::UnexpectedToken, llc::TokenType::SemiColon },
+        { "4;", llc::DiagCode::ExpectedToken, llc::TokenType::SemiColon },
+        { "begin;", llc::DiagCode::ExpectedToken, llc::TokenType::Assign },
+    };
+
+    llc::Arena arena;
+    llc::Diagnostics diagnostics;
+    llc::Program* program = ParseText(text, arena, diagnostics);
+
+    Check(diagnostics.size() == sizeof(expected) / sizeof(expected[0]), std::to_string(diagnostics.size()) + " diagnostics");
+    for (std::size_t i = 0; i < diagnostics.size() && i < sizeof(expected) / sizeof(expected[0]); ++i)
+    {
+        const llc::Diagnostic& d = diagnostics.records()[i];
+        Check(d.offset == text.find(expected[i].at) && d.code == expected[i].code
+            && d.arg == static_cast<char>(expected[i].arg), "diagnostic " + std::to_string(i) + " at " + std::to_string(d.offset));
+    }
+
+    std::string decls;
+    for (const llc::Decl* decl = program->decls; decl != nullptr; decl = decl->next)
+    {
+        decls += std::string(decl->name) + " ";
+    }
+    Check(decls == "x z q ", "declarations: " + decls);
+
+    const llc::Decl* q = program->decls && program->decls->next ? program->decls->next->next : nullptr;
+    Check(q != nullptr && DescribeAssignments(q->body) == "a=1 ", "procedure body: " + (q ? DescribeAssignments(q->body) : ""));
+    Check(DescribeAssignments(program->body) == "z=2 b=3 z=3 z=4 ", "program body: " + DescribeAssignments(program->body));
+}
+
+//Cut the valid program at every byte: parsing must stop at Eof with at most
+//one error there, and never look past it
+void TestParserEof()
+{
+    std::string full = kValidProgram;
+    int before = failures;
+    for (std::size_t size = 0; size < full.size(); ++size)
+    {
+        std::string text = full.substr(0, size);
+        llc::Arena arena;
+        llc::Diagnostics diagnostics;
+        ParseText(text, arena, diagnostics);
+
+        std::string what = "cut at " + std::to_string(size);
+        bool complete = size >= full.find("end program") + 11;
+        Check(complete ? diagnostics.empty() : !diagnostics.empty(), what + ": " + std::to_string(diagnostics.size()) + " diagnostics");
+
+        std::size_t at_eof = 0;
+        for (std::size_t i = 0; i < diagnostics.size(); ++i)
+        {
+            std::uint32_t offset = diagnostics.records()[i].offset;
+            Check(offset <= size, what + ": diagnostic past the end");
+            Check(i == 0 || offset > diagnostics.records()[i - 1].offset, what + ": two diagnostics on one token");
+            at_eof += offset == size ? 1 : 0;
+        }
+        Check(at_eof <= 1, what + ": " + std::to_string(at_eof) + " diagnostics at Eof");
+        if (failures != before)
+        {
+            return;
+        }
+    }
+}
+
+const TestCase kTests[] = {
+    { "parallel", TestParallel },
+    { "incremental", TestIncremental },
+    { "stream", TestStream },
+    { "stream-symbols", TestStreamSymbols },
+    { "dfa", TestDfa },
+    { "reset", TestReset },
+    { "policies", TestPolicies },
+    { "binary-dump", TestBinaryDump },
+    { "token-cache", TestTokenCache },
+    { "strings", TestStringRecovery },
+    { "diagnostic-limit", TestDiagnosticLimit },
+    { "numbers", TestNumberValues },
+    { "parser-valid", TestParserValid },
+    { "parser-recovery", TestParserRecovery },
+    { "parser-eof", TestParserEof },
+};
+
+int main(int argc, char* argv[])
+{
+    for (const TestCase& test : kTests)
+    {
+        bool selected = argc < 2;
+        for (int i = 1; i < argc; ++i)
+        {
+            selected = selected || std::string(argv[i]) == test.name;
+        }
+        if (!selected)
+        {
+            continue;
+        }
+
+        int before = failures;
+        test.run();
+        std::cout << (failures == before ? "ok   " : "FAIL ") << test.name << std::endl;
+    }
+
+    return failures == 0 ? 0 : 1;
+}